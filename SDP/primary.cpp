@@ -4,85 +4,12 @@
 #include "FEHUtility.h"
 #include "FEHImages.h"
 #include "FEHRandom.h"
+#include "FEHEntities.h"
+#include "FEHScene.h"
+#include "FEHWidgets.h"
+#include <math.h>
 #define JUMPSPEED 0.06
 
-/* Class for buttons on the menu page
-
-Variables:
-- xPos and yPos describe the button's position
-- xSize and ySize describe the button's size
-- image and clickedImage are the images for the button
-- screenToInvoke is the screen to change to when button is clicked
-- clicked is whether or not the button has been clicked
-
-Functions:
--  Constructor initializes the button and fills each field with info
--  callScreen returns the screen associated with the button
--  draw() draws the button and returns if it has been clicked
--  draw(float, float) draws the button and checks if it's being clicked
-
-Written by both Hannah and Pierre
-*/
-
-class Button{
-    private:
-        float xPos;
-        float yPos;
-        float xSize;
-        float ySize;
-        FEHImage image;
-        FEHImage clickedImage;
-        int screenToInvoke;
-        bool clicked = false;
-    public:
-        // Constructor written by Hannah
-        Button(char img[], char img2[], float x, float y, float xS, float yS, int screen){
-            image.Open(img);
-            clickedImage.Open(img2);
-            screenToInvoke = screen;
-            xSize = xS;
-            ySize = yS;
-            xPos = x;
-            yPos = y;
-        }
-
-        // Written by Hannah
-        // Returns screen associated with the button
-        int callScreen(){
-            return screenToInvoke;
-        } 
-
-
-        // Overloaded method
-        // Written by Hannah
-        // Returns true if it has been clicked, false if not. Draws button if not.
-        bool draw(){
-                if(!clicked){
-                    image.Draw(xPos, yPos);
-                    return false;
-                }else{
-                    clicked = false;
-                    return true;
-                }
-                
-            
-        }
-
-        // Written by Hannah and Pierre
-        // Draws button and checks if it's being clicked.
-        void draw(float xClicked, float yClicked){
-            if(xClicked > xPos && xClicked < (xPos+xSize) && yClicked > yPos && yClicked < (yPos+ySize)){
-                clickedImage.Draw(xPos, yPos);
-                clicked = true;
-            }else{
-                image.Draw(xPos, yPos);
-            }
-            
-        }
-        
-
-};
-
 /* Class that describes the character
 
 Variables:
@@ -92,6 +19,7 @@ Variables:
 - jumpIndex is a number denoting where the character is in its jump
 - colliding is an int denoting if a character has just collided and should thus have the red/green flash costume
 - image is the image associated with the character
+- collidedCostume and healedCostume are the red and green flash costumes
 
 Functions:
 - changeCostume sets the image to the parameter
@@ -107,16 +35,18 @@ class Character{
         float yPos = 85;
         int jumpIndex = 0;
         int colliding = 0;
-        FEHImage image;
+        FEHImage *image = NULL;
+        FEHImage *collidedCostume = NULL;
+        FEHImage *healedCostume = NULL;
 
-        // Changes image of character to costume[]
-        void changeCostume(char costume[]){
-            image.Open(costume);
+        // Changes image of character to costume (an already loaded image, so this is free to call every frame)
+        void changeCostume(FEHImage *costume){
+            image = costume;
         }
 
         // Draws the character
         void drawChar(){
-            image.Draw(30, yPos);
+            image->Draw(30, yPos);
         }
 
         // Changes yPos based on the character's point in the jump. Ends jump if reached the ground.
@@ -150,7 +80,6 @@ Variables:
 - image is the image associated with the Ground
 
 Functions:
-- Constructor initializes the Ground with the correct image
 - drawGround draws the Ground at the current position
 
 Written by Hannah
@@ -158,16 +87,11 @@ Written by Hannah
 class Ground{
     public:
         float position;
-        FEHImage image;
-        
-        // Initializes all Ground with the same image
-        Ground(){
-            image.Open("Ground/Ground-1.png");
-        }
-        
-        // Draws ground at current position
+        FEHImage *image;
+
+        // Draws ground at current position (sub-pixel so slow scrolling stays smooth)
         void drawGround(){
-           image.Draw(position,0);
+           image->DrawSubpixel(position,0);
        }
         
 
@@ -180,7 +104,6 @@ Variables:
 - image is the image associated with the Background
 
 Functions:
-- Constructor initializes the Background with the correct image
 - drawGround draws the Background at the current position
 
 Written by Hannah
@@ -188,56 +111,16 @@ Written by Hannah
 class Background{
     public:
         float position;
-        FEHImage image;
-        
-        // Initializes all Background with the same image
-        Background(){
-            image.Open("Backgrounds/BackgroundWClouds.png");
-        }
+        FEHImage *image;
 
-        // Draws background at current position
+        // Draws background at current position (sub-pixel so the moveSpeed/4 parallax stays smooth)
         void drawGround(){
-           image.Draw(position,0);
+           image->DrawSubpixel(position,0);
        }
         
 
 };
 
-/* Class that describes the obstacles (both good and bad)
-
-Variables:
-- xPos and yPos are position of obstacle
-- generated is a boolean describing whether or not the obstacle is visible and can collide
-- imageName is the name of the obstacle's image
-- image is the image that draws the obstacle
-
-Functions:
-- Constructor initializes the Obstacle with an arbitrary image
-- draw draws the obstacle at its current position
-
-Written by Pierre
-*/
-class Obstacle{
-    public:
-        float xPos;
-        float yPos;
-        bool generated = false;
-        char imageName[30] = "";
-        FEHImage image;
-        
-        // Initializes obstacle at point off the screen with arbitrary image
-        Obstacle(){
-            image.Open("obstacles/AlarmClock.png");
-            xPos = 400;
-            yPos = 0;
-        }
-
-        // Draws obstacle at current position
-        void draw(){
-            image.Draw(xPos, yPos);
-        }
-};
-
 /* Class that describes the jump bar
 
 Variables:
@@ -247,8 +130,9 @@ Variables:
 - xPos and yPos are the position of the bar
 
 Functions:
-- resetBar draws the bar when the screen is not being clicked
-- increaseBar draws the bar when the screen is being clicked
+- resetBar empties the bar when the screen is not being clicked
+- increaseBar grows the bar when the screen is being clicked
+- drawBar draws the bar
 
 Written by Hannah
 */
@@ -262,23 +146,18 @@ class JumpBar{
 
     public:
         // If screen is not currently being clicked
-        void resetBar(int stressIndex){
+        void resetBar(){
             innerX = 0;
-            LCD.SetFontColor(WHITE);
-            LCD.FillRectangle(xPos,yPos,totalX,totalY); 
-
-            // Part of bar affected by stress
-            LCD.SetFontColor(RED);
-            LCD.FillRectangle(totalX - (stressIndex * 5) + 15,yPos,(stressIndex * 5),totalY); 
         }
 
-        void increaseBar(int max, int stressIndex){
-            // Increase size of blue part of bar
+        // Increase size of blue part of bar
+        void increaseBar(int max){
             if(innerX < max){
                 innerX++;
             }
-            
-            // Draw bar
+        }
+
+        void drawBar(int stressIndex){
             LCD.SetFontColor(WHITE);
             LCD.FillRectangle(xPos,yPos,totalX,totalY); 
             LCD.SetFontColor(LIGHTBLUE);
@@ -290,11 +169,11 @@ class JumpBar{
         }
 };
 
-
 /* Function for effects of collision with an obstacle
 
 Inputs:
-- hitObstacle is pointer to the obstacle the player collided with
+- obstacles is the store holding the obstacle the player collided with
+- hitObstacle is the id of that obstacle in the store
 - hitPlayer is pointer to the player
 - screen is pointer to the variable that controls the current displaying screen
 
@@ -306,12 +185,11 @@ if stress is too high
 
 Written by Pierre
 */
-void collideObstacle(Obstacle *hitObstacle, Character *hitPlayer, int *screen) {
-    hitObstacle->generated = false;
-    hitObstacle->xPos = -251;
+void collideObstacle(FEHEntities *obstacles, int hitObstacle, Character *hitPlayer, int *screen) {
+    obstacles->Despawn(hitObstacle);
     hitPlayer->stressIndex++;
 
-    (*hitPlayer).changeCostume("Collided.png");
+    (*hitPlayer).changeCostume((*hitPlayer).collidedCostume);
     (*hitPlayer).colliding = 15;
 
     // End game
@@ -323,7 +201,8 @@ void collideObstacle(Obstacle *hitObstacle, Character *hitPlayer, int *screen) {
 /* Function for effects of collision with a good object
 
 Inputs:
-- hitObject is pointer to the object the player collided with
+- objects is the store holding the object the player collided with
+- hitObject is the id of that object in the store
 - hitPlayer is pointer to the player
 
 Outputs: 
@@ -333,15 +212,14 @@ and sets its costume to the green flash
 
 Written by Pierre
 */
-void collideObject(Obstacle *hitObject, Character *hitPlayer) {
-    hitObject->generated = false;
-    hitObject->xPos = -251;
+void collideObject(FEHEntities *objects, int hitObject, Character *hitPlayer) {
+    objects->Despawn(hitObject);
     // Give stress back
     if(hitPlayer->stressIndex > 0){
         hitPlayer->stressIndex--;
     }
 
-    (*hitPlayer).changeCostume("Healed.png");
+    (*hitPlayer).changeCostume((*hitPlayer).healedCostume);
     (*hitPlayer).colliding = 15;
 }
 
@@ -365,90 +243,345 @@ void checkScore(float *score, float *maxScore){
     }        
 }
 
-/* Main method
-Purpose: Runs the game; details in comments throughout
-Written by both Hannah and Pierre
+/* Struct for the results shared between screens
+
+Variables:
+- score is the score of the current (or last) run
+- maxScore is the high score
+- runsPlayed is how many runs have ended
 */
-int main()
-{
-    // 1: menu, 2: stats, 3: credits, 4: instructions, 5: game, 6: game over
-    int screen = 1;
+struct Progress{
+    float score = 0;
+    float maxScore = 0;
+    int runsPlayed = 0;
+};
 
-    // Variables for the menu
-    Button startButton("Buttons/sprite_0.png", "Buttons/sprite_1.png", 90, 150, 60, 25, 5);
-    Button statsButton("Buttons/sprite_2.png", "Buttons/sprite_3.png", 65, 190, 60, 25, 2);
-    Button creditsButton("Buttons/sprite_4.png", "Buttons/sprite_5.png", 160, 190, 60, 25, 3);
-    Button infoButton("Buttons/sprite_6.png", "Buttons/sprite_7.png", 160, 150, 60, 25, 4);
+/* Menu screen (1)
 
-    // Variables for info page
-    FEHImage instructions;
-    instructions.Open("info2.png");
+Variables:
+- ui holds the logo and the four buttons leading to the other screens
 
-    // Variables for game over page
-    FEHImage reminder;
-    reminder.Open("EndReminder.png");
+Functions:
+- Enter loads the images and redraws the whole menu
+- Update checks the buttons and returns the screen to change to
+- Draw redraws whatever changed (nothing, unless a button is pressed)
+*/
+class MenuScene : public FEHScene{
+    private:
+        FEHWidgetTree ui{LIGHTBLUE};
+        FEHPicture logo{45, 10};
+        FEHImageButton startButton{90, 150, 60, 25};
+        FEHImageButton statsButton{65, 190, 60, 25};
+        FEHImageButton creditsButton{160, 190, 60, 25};
+        FEHImageButton infoButton{160, 150, 60, 25};
 
-    // Variables for the game
-    Character player;
-    char crouches[6][35] = {"Char_crouch/sprite_0_crouch.png", "Char_crouch/sprite_2_crouch.png", "Char_crouch/sprite_4_crouch.png", "Char_crouch/sprite_6_crouch.png", "Char_crouch/sprite_8_crouch.png", "Char_crouch/sprite_10_crouch.png"};
-    char stands[6][35] = {"character/sprite_00.png", "character/sprite_02.png", "character/sprite_04.png", "character/sprite_06.png", "character/sprite_08.png", "character/sprite_10.png"};
-    char jumps[6][35] = {"character/sprite_01.png", "character/sprite_03.png", "character/sprite_05.png", "character/sprite_07.png", "character/sprite_09.png", "character/sprite_11.png"};
-    player.changeCostume(stands[0]);
+    public:
+        MenuScene(){
+            ui.Add(&logo);
+            ui.Add(&startButton);
+            ui.Add(&statsButton);
+            ui.Add(&creditsButton);
+            ui.Add(&infoButton);
+        }
 
-    FEHImage background;
-    background.Open("Backgrounds/BlueBackground-1.png");
+        void Enter(){
+            logo.SetImage(assets.Load("Logo-2.png.png"));
+            startButton.SetImages(assets.Load("Buttons/sprite_0.png"), assets.Load("Buttons/sprite_1.png"));
+            statsButton.SetImages(assets.Load("Buttons/sprite_2.png"), assets.Load("Buttons/sprite_3.png"));
+            creditsButton.SetImages(assets.Load("Buttons/sprite_4.png"), assets.Load("Buttons/sprite_5.png"));
+            infoButton.SetImages(assets.Load("Buttons/sprite_6.png"), assets.Load("Buttons/sprite_7.png"));
 
-    float score = 0;
-    float maxScore = 0;
-    int runsPlayed = 0;
- 
-    Ground currGround [3];
-    Background currBackground [3];
+            // Also ensures no double click: the click that led here is ignored until it's let go
+            ui.Invalidate();
+        }
 
-    currGround[0].position = 0;
-    currGround[1].position = 300;
-    currGround[2].position = 600;
+        int Update(){
+            ui.Update();
 
-    currBackground[0].position = 0;
-    currBackground[1].position = 300;
-    currBackground[2].position = 600;
+            if(startButton.Clicked()){
+                return 5;
+            }
+            if(infoButton.Clicked()){
+                return 4;
+            }
+            if(statsButton.Clicked()){
+                return 2;
+            }
+            if(creditsButton.Clicked()){
+                return 3;
+            }
+            return FEH_SCENE_STAY;
+        }
 
-    Obstacle currentObstacles[15];
-    Obstacle currentObjects[15]; // "Objects" refer to the good obstacles
-    
-    char objectImages[7][30] = {"objects/Bed.png", "objects/Heart.png","objects/Coffee.png","objects/Outside.png", "objects/Sports.png", "objects/Call.png", "objects/Journal.png"};
-    char obstacleImages[12][30] = {"obstacles/AlarmClock.png",
-    "obstacles/Bill.png", "obstacles/Cell_Phone.png", "obstacles/Clock.png", 
-   "obstacles/books.png", "obstacles/Thunder.png", "obstacles/paper1.png","obstacles/Application.png", 
-   "obstacles/messages.png","obstacles/News.png","obstacles/Email.png", "obstacles/Phone2.png"};
-
-    JumpBar bar;
-
-    int currObjectGenerated = 0;
-    int currObstacleGenerated = 0;
-    float lastGeneratedX = 100;
-    float lastObGeneratedX = 200;
-    float currGenerationDistance = 50;
-    float currObGenerationDistance = 500;
-    float currObstacleGenMax = 390;
-
-    float timeHeld = 0;
-    float moveSpeed = 0;
-    int jumpLevel = 0;
-
-    bool resetTime = false;
-
-    // Ensures no double click
-    bool released = false;
-
-    while (1) {
-        // If game needs to be reset, set variables back
-        if(resetTime){
-            runsPlayed++;
-            released = false;
-            
-            currObjectGenerated = 0;
-            currObstacleGenerated = 0;
+        void Draw(){
+            ui.Draw();
+        }
+};
+
+/* Stats screen (2)
+
+Variables:
+- progress holds the high score and runs played
+- ui holds the text
+
+Functions:
+- Enter redraws the whole screen
+- Update shows the latest stats and returns to the menu when clicked
+- Draw redraws whatever changed
+*/
+class StatsScene : public FEHScene{
+    private:
+        Progress *progress;
+        FEHWidgetTree ui{LIGHTPINK};
+        FEHLabel highScoreText{70, 120, "High Score:", MAROON};
+        FEHLabel highScore{210, 120, "0", MAROON, 8};
+        FEHLabel runsText{60, 90, "Runs Played:", MAROON};
+        FEHLabel runs{220, 90, "0", MAROON, 8};
+        FEHLabel returnText{10, 210, "Click anywhere to return", LIGHTCORAL};
+
+    public:
+        StatsScene(Progress *p){
+            progress = p;
+            ui.Add(&highScoreText);
+            ui.Add(&highScore);
+            ui.Add(&runsText);
+            ui.Add(&runs);
+            ui.Add(&returnText);
+        }
+
+        void Enter(){
+            ui.Invalidate();
+        }
+
+        int Update(){
+            highScore.SetText((int)progress->maxScore/100);
+            runs.SetText(progress->runsPlayed);
+
+            float x_pos;
+            float y_pos;
+
+            if(LCD.Touch(&x_pos, &y_pos, false)){
+                return 1;
+            }
+            return FEH_SCENE_STAY;
+        }
+
+        void Draw(){
+            ui.Draw();
+        }
+};
+
+/* Credits screen (3)
+
+Variables:
+- ui holds the text and the studio's logo
+
+Functions:
+- Enter loads the logo and redraws the whole screen
+- Update returns to the menu when clicked
+- Draw redraws whatever changed
+*/
+class CreditsScene : public FEHScene{
+    private:
+        FEHWidgetTree ui{LIGHTGOLDENRODYELLOW};
+        FEHLabel title{100, 20, "An Escaping", BROWN};
+        FEHLabel studio{50, 35, "Meatball Production", BROWN};
+        FEHPicture brand{95, 40};
+        FEHLabel authors{25, 164, "Hannah Hofferberth and", BROWN};
+        FEHLabel authors2{60, 180, "Pierre van Zyl", BROWN};
+        FEHLabel returnText{10, 210, "Click anywhere to return", BURLYWOOD};
+
+    public:
+        CreditsScene(){
+            ui.Add(&title);
+            ui.Add(&studio);
+            ui.Add(&brand);
+            ui.Add(&authors);
+            ui.Add(&authors2);
+            ui.Add(&returnText);
+        }
+
+        void Enter(){
+            brand.SetImage(assets.Load("Logo2x.png"));
+            ui.Invalidate();
+        }
+
+        int Update(){
+            float x_pos;
+            float y_pos;
+
+            if(LCD.Touch(&x_pos, &y_pos, false)){
+                return 1;
+            }
+            return FEH_SCENE_STAY;
+        }
+
+        void Draw(){
+            ui.Draw();
+        }
+};
+
+/* Instructions screen (4)
+
+Variables:
+- ui holds the title and the image explaining how to play
+
+Functions:
+- Enter loads the instructions and redraws the whole screen
+- Update returns to the menu when clicked
+- Draw redraws whatever changed
+*/
+class InfoScene : public FEHScene{
+    private:
+        FEHWidgetTree ui{LIGHTGREEN};
+        FEHLabel title{85, 10, "How to play:", DARKGREEN};
+        FEHPicture instructions{45, 40};
+        FEHLabel returnText{10, 215, "Click anywhere to return", GREEN};
+
+    public:
+        InfoScene(){
+            ui.Add(&title);
+            ui.Add(&instructions);
+            ui.Add(&returnText);
+        }
+
+        void Enter(){
+            instructions.SetImage(assets.Load("info2.png"));
+            ui.Invalidate();
+        }
+
+        int Update(){
+            float x_pos;
+            float y_pos;
+
+            if(LCD.Touch(&x_pos, &y_pos, false)){
+                return 1;
+            }
+            return FEH_SCENE_STAY;
+        }
+
+        void Draw(){
+            ui.Draw();
+        }
+};
+
+/* Game screen (5)
+
+Variables:
+- progress holds the score, which is updated as the player runs
+- player, currGround, currBackground, background and bar are what is drawn each frame
+- crouches, stands and jumps are the player's costumes for each stress level
+- currentObstacles and currentObjects hold what is on screen, and the broadphases find which are near the player
+- the rest are the state of the run (spawning distances, jump state, ...)
+
+Functions:
+- Enter loads every image and starts a new run
+- Exit drops the obstacle/object images along with the rest of the screen's images
+- Update runs the game for one frame and returns 6 once the game is over
+- Draw draws the game
+*/
+class GameScene : public FEHScene{
+    private:
+        Progress *progress;
+
+        Character player;
+        Ground currGround [3];
+        Background currBackground [3];
+        FEHImage *background;
+        JumpBar bar;
+
+        FEHImage *crouches[6];
+        FEHImage *stands[6];
+        FEHImage *jumps[6];
+
+        // Obstacles and objects live in entity stores; each one only keeps its kind (which image it is, from the lists in Enter)
+        FEHEntities currentObstacles{64};
+        FEHEntities currentObjects{64}; // "Objects" refer to the good obstacles
+
+        // Each frame these are refilled with where every obstacle/object is, so collision checks only look at nearby ones
+        FEHBroadphase obstacleBroadphase{64};
+        FEHBroadphase objectBroadphase{64};
+
+        // The character's body within its 128x128 costumes
+        FEHHitbox playerHitbox = {54, 40, 78, 90};
+
+        float lastGeneratedX;
+        float lastObGeneratedX;
+        float currGenerationDistance;
+        float currObGenerationDistance;
+        float currObstacleGenMax;
+
+        float timeHeld;
+        float moveSpeed;
+        int jumpLevel;
+
+    public:
+        // Sized for the 3 scenery images, 18 costumes, 2 flashes and 19 obstacles/objects
+        GameScene(Progress *p) : FEHScene(48){
+            progress = p;
+        }
+
+        void Enter(){
+            char crouchFiles[6][35] = {"Char_crouch/sprite_0_crouch.png", "Char_crouch/sprite_2_crouch.png", "Char_crouch/sprite_4_crouch.png", "Char_crouch/sprite_6_crouch.png", "Char_crouch/sprite_8_crouch.png", "Char_crouch/sprite_10_crouch.png"};
+            char standFiles[6][35] = {"character/sprite_00.png", "character/sprite_02.png", "character/sprite_04.png", "character/sprite_06.png", "character/sprite_08.png", "character/sprite_10.png"};
+            char jumpFiles[6][35] = {"character/sprite_01.png", "character/sprite_03.png", "character/sprite_05.png", "character/sprite_07.png", "character/sprite_09.png", "character/sprite_11.png"};
+            for(int i = 0; i < 6; i++){
+                crouches[i] = assets.Load(crouchFiles[i]);
+                stands[i] = assets.Load(standFiles[i]);
+                jumps[i] = assets.Load(jumpFiles[i]);
+            }
+            player.collidedCostume = assets.Load("Collided.png");
+            player.healedCostume = assets.Load("Healed.png");
+
+            background = assets.Load("Backgrounds/BlueBackground-1.png");
+            FEHImage *ground = assets.Load("Ground/Ground-1.png");
+            FEHImage *clouds = assets.Load("Backgrounds/BackgroundWClouds.png");
+            for(int i = 0; i < 3; i++){
+                currGround[i].image = ground;
+                currBackground[i].image = clouds;
+            }
+
+            char objectImages[7][30] = {"objects/Bed.png", "objects/Heart.png","objects/Coffee.png","objects/Outside.png", "objects/Sports.png", "objects/Call.png", "objects/Journal.png"};
+            char obstacleImages[12][30] = {"obstacles/AlarmClock.png",
+            "obstacles/Bill.png", "obstacles/Cell_Phone.png", "obstacles/Clock.png", 
+           "obstacles/books.png", "obstacles/Thunder.png", "obstacles/paper1.png","obstacles/Application.png", 
+           "obstacles/messages.png","obstacles/News.png","obstacles/Email.png", "obstacles/Phone2.png"};
+
+            // Hitboxes for each image above, relative to its upper left corner: left, top, right, bottom
+            // These cover the visible part of each image; obstacles are shrunk by 3 pixels so near misses don't count
+            FEHHitbox objectHitboxes[7] = {
+                {9, 15, 68, 58},    // Bed
+                {1, 2, 18, 19},     // Heart
+                {4, 5, 28, 28},     // Coffee
+                {10, 13, 55, 52},   // Outside
+                {18, 19, 49, 46},   // Sports
+                {7, 9, 58, 54},     // Call
+                {10, 12, 53, 53}    // Journal
+            };
+            FEHHitbox obstacleHitboxes[12] = {
+                {4, 6, 16, 17},     // AlarmClock
+                {6, 3, 14, 17},     // Bill
+                {8, 3, 12, 17},     // Cell_Phone
+                {3, 3, 17, 17},     // Clock
+                {9, 19, 57, 53},    // books
+                {18, 21, 62, 62},   // Thunder
+                {8, 15, 30, 32},    // paper1
+                {12, 13, 30, 29},   // Application
+                {13, 24, 44, 42},   // messages
+                {12, 13, 30, 29},   // News
+                {13, 16, 30, 24},   // Email
+                {17, 14, 23, 30}    // Phone2
+            };
+
+            // Register each image as a kind, in list order so kind i is image i; each image is decoded once here and shared by every spawn
+            for(int i = 0; i < 7; i++){
+                currentObjects.AddKind(*assets.Load(objectImages[i]), objectHitboxes[i]);
+            }
+            for(int i = 0; i < 12; i++){
+                currentObstacles.AddKind(*assets.Load(obstacleImages[i]), obstacleHitboxes[i]);
+            }
+
+            // Set everything back for a new run
             lastGeneratedX = 100;
             lastObGeneratedX = 200;
             currGenerationDistance = 50;
@@ -471,113 +604,34 @@ int main()
             player.stressIndex = 0;
             player.xPos = 0;
             player.yPos = 85;
-            
-            score = 0;
-            timeHeld = 0;
+            player.jumpIndex = 0;
             player.changeCostume(stands[0]);
 
-            for(int i = 0; i < 15; i++){
-                currentObstacles[i].generated = false;
-                
-            }
-
-            for(int i = 0; i < 15; i++){
-                currentObjects[i].generated = false;
-                
-            }
+            progress->score = 0;
+            bar.resetBar();
+        }
 
-            resetTime = false;
+        void Exit(){
+            // The stores hold on to their kinds' images, so let go of them too
+            currentObstacles.ClearKinds();
+            currentObjects.ClearKinds();
         }
-        
-        // Menu
-        if(screen == 1){
-          // background
-            LCD.SetFontColor(LIGHTBLUE);
-            LCD.FillRectangle(0,0,319,239); 
 
-            // Declares an image for logo
-            FEHImage logo;
-            // Open the image
-            logo.Open("Logo-2.png.png");
-            // Draw the logo
-            logo.Draw(45, 10);
+        int Update(){
+            LCD.Phase("simulate"); // for profiling, see FEH_BENCH
+            int screen = FEH_SCENE_STAY;
 
+            // check if screen clicked or space held; either one charges the jump
             float x_pos;
             float y_pos;
+            bool charging = LCD.Touch(&x_pos, &y_pos,false) || LCD.KeyHeld(TK_SPACE);
 
-            // Draw buttons and detect if they were clicked
-            if(LCD.Touch(&x_pos, &y_pos,false) && moveSpeed == 0){
-                startButton.draw(x_pos, y_pos);
-                infoButton.draw(x_pos, y_pos);
-                statsButton.draw(x_pos, y_pos);
-                creditsButton.draw(x_pos, y_pos);
-                
-            }else{
-                if(released){
-                    if(startButton.draw()){
-                    screen = startButton.callScreen();
-                    }
-                    if(infoButton.draw()){
-                        screen = infoButton.callScreen();
-                    }
-                    if(statsButton.draw()){
-                        screen = statsButton.callScreen();
-                    }
-                    if(creditsButton.draw()){
-                        screen = creditsButton.callScreen();
-                    }
-                }else{
-                    startButton.draw();
-                    infoButton.draw();
-                    statsButton.draw();
-                    creditsButton.draw();
-                    released = true;
+            if(charging && moveSpeed == 0){
+                if(timeHeld == 0){
+                    LCD.Reacted(); // started crouching
                 }
-                
-            }
-
-            
-        // Actual game
-        }else if(screen == 5){
-            // background
-            background.Draw(0,0);
-
-            // score
-            LCD.SetFontColor(WHITESMOKE);
-            int placesLeft = 0;
-            if(((int)score / 100) / 10 != 0){
-                placesLeft = 1;
-                if(((int)score / 100) / 100 != 0){
-                    placesLeft = 2;
-                }
-                if(((int)score / 100) / 1000 != 0){
-                    placesLeft = 3;
-                }
-            }
-
-            LCD.WriteAt((int)score / 100, 290 - placesLeft * 10, 10);
-
-            
-            // sprites
-
-            // Ground
-            currGround[0].drawGround();
-            currGround[1].drawGround();
-            currGround[2].drawGround();
-            // Background
-            currBackground[0].drawGround();
-            currBackground[1].drawGround();
-            currBackground[2].drawGround();
-            // Player
-            player.drawChar();
-
-            // check if screen clicked
-            float x_pos;
-            float y_pos;
-
-            if(LCD.Touch(&x_pos, &y_pos,false) && moveSpeed == 0){
                 timeHeld++;
-                bar.increaseBar(75 - (player.stressIndex * 5), player.stressIndex);
+                bar.increaseBar(75 - (player.stressIndex * 5));
                 if(player.colliding == 0){
                     player.changeCostume(crouches[(int)player.stressIndex]);
                 }else{
@@ -591,6 +645,7 @@ int main()
 
                     // Set image to correct jumping sprite
                     player.changeCostume(jumps[(int)player.stressIndex]);
+                    LCD.Reacted();
                     // Set jump info
                     jumpLevel = timeHeld;
                     timeHeld = 0;
@@ -608,7 +663,7 @@ int main()
                     // Move character and transition where it is in its jump
                     player.transitionJump(jumpLevel); 
                     player.xPos += moveSpeed;
-                    score += moveSpeed;
+                    progress->score += moveSpeed;
 
                     // Reset xPos every so often so it never gets too large
                     if(player.xPos > 2000){
@@ -627,7 +682,7 @@ int main()
                 }
 
                 // Set bar back to normal (no inner blue bar)
-                bar.resetBar(player.stressIndex);
+                bar.resetBar();
                 
             }
 
@@ -666,33 +721,27 @@ int main()
                 currObstacleGenMax -= 0.03;
             }
 
+            LCD.Phase("spawn");
+
             // Generate good objects
             if(player.xPos - lastObGeneratedX > currObGenerationDistance){ //If it's time for a new object to be generated
 
-                currentObjects[currObjectGenerated].xPos = 350;
-                currentObjects[currObjectGenerated].yPos = 155;
+                float yPos = 155;
 
                 // Randomize which object will appear
                 int random = 7 * (Random.RandInt() / 32767.0);
-                currentObjects[currObjectGenerated].image = objectImages[random];
-                strcpy(currentObjects[currObjectGenerated].imageName, objectImages[random]);
-                // Set its status to "generated" (will appear and collide)
-                currentObjects[currObjectGenerated].generated = true;
                 
                 // Depending on which was generated, sets y-pos
                  if(random == 1 || random == 2){
-                    currentObjects[currObjectGenerated].yPos = 100 * (Random.RandInt() / 32767.0) + 55;
+                    yPos = 100 * (Random.RandInt() / 32767.0) + 55;
                  }else if(random == 0){
-                    currentObjects[currObjectGenerated].yPos = 120;
+                    yPos = 120;
                  }else if(random == 3 || random == 4 || random == 5|| random == 6 || random == 7){
-                    currentObjects[currObjectGenerated].yPos = 80 * (Random.RandInt() / 32767.0) + 35;
+                    yPos = 80 * (Random.RandInt() / 32767.0) + 35;
                  }
 
-                if(currObjectGenerated < 14){ // If the array of current objects isn't full, move to next element for next time
-                    currObjectGenerated++;
-                }else{ // If the array is full, start back from the beginning (replace objects that have gone off the screen)
-                    currObjectGenerated = 0;
-                }
+                // Add it to the store (will appear and collide); if the store is full it is skipped
+                currentObjects.Spawn(random, 350, yPos);
                 
                 lastObGeneratedX = player.xPos; // Note where last object was generated
 
@@ -704,34 +753,26 @@ int main()
             // Generate obstacles
             if(player.xPos - lastGeneratedX > currGenerationDistance){ //If it's time for a new obstacle to be generated
                
-                currentObstacles[currObstacleGenerated].xPos = 350;
-                currentObstacles[currObstacleGenerated].yPos = 155;
+                float yPos = 155;
 
                 // Randomize which obstacle will appear
                 int random = 12 * (Random.RandInt() / 32767.0);
-                currentObstacles[currObstacleGenerated].image = obstacleImages[random];
-                strcpy(currentObstacles[currObstacleGenerated].imageName, obstacleImages[random]);
-                // Set its status to "generated" (will appear and collide)
-                currentObstacles[currObstacleGenerated].generated = true;
 
                 // Depending on which was generated, sets y-pos
                 if(random == 5){
-                    currentObstacles[currObstacleGenerated].yPos = 140 * (Random.RandInt() / 32767.0) - 40;
+                    yPos = 140 * (Random.RandInt() / 32767.0) - 40;
                 }else if(random == 4){
-                    currentObstacles[currObstacleGenerated].yPos = 120;
+                    yPos = 120;
                 }else if(random == 8 || random == 9 || random == 10){
-                    currentObstacles[currObstacleGenerated].yPos = 100 * (Random.RandInt() / 32767.0);
+                    yPos = 100 * (Random.RandInt() / 32767.0);
                 }else if(random == 7 || random == 6){
-                    currentObstacles[currObstacleGenerated].yPos = 147;
+                    yPos = 147;
                 }else if(random == 11){
-                    currentObstacles[currObstacleGenerated].yPos = 147;
+                    yPos = 147;
                 }
 
-                if(currObstacleGenerated < 14){ // If the array of current obstacles isn't full, move to next element for next time
-                    currObstacleGenerated++;
-                }else{ // If the array is full, start back from the beginning (replace obstacles that have gone off the screen)
-                    currObstacleGenerated = 0;
-                }
+                // Add it to the store (will appear and collide); if the store is full it is skipped
+                currentObstacles.Spawn(random, 350, yPos);
                 
                 lastGeneratedX = player.xPos; // Note where last obstacle was generated
 
@@ -740,288 +781,172 @@ int main()
                 currGenerationDistance = randomDistance;
             }
 
-            // Draw objects
-            for(int i = 0; i < 15; i++){
-                if(currentObjects[i].generated){
-                    currentObjects[i].xPos -= moveSpeed;
-                    currentObjects[i].draw();
-
-                    if(currentObjects[i].xPos < -250){
-                        currentObjects[i].generated = false;
-                    }
-                }
-                
-            }
-
-            // Draw obstacles
-            for(int i = 0; i < 15; i++){
-                if(currentObstacles[i].generated){
-                    currentObstacles[i].xPos -= moveSpeed;
-                    currentObstacles[i].draw();
+            LCD.Phase("simulate");
 
-                    if(currentObstacles[i].xPos < -250){
-                        currentObstacles[i].generated = false;
-                    }
-                }
-                
+            // Move and remove (once off the screen) objects and obstacles, registering the rest for collisions
+            currentObjects.Update(moveSpeed, -250, objectBroadphase);
+            currentObstacles.Update(moveSpeed, -250, obstacleBroadphase);
 
-            }
+            LCD.Phase("collide");
 
             // Check collisions
-
-            // Check obstacles
-            for(int i = 0; i < 15; i++){
-                if (currentObstacles[i].generated) {
-                    if (strcmp(currentObstacles[i].imageName, obstacleImages[0]) == 0) { // AlarmClock
-                        if (currentObstacles[i].xPos < 100 && currentObstacles[i].xPos > 70 && player.yPos > 60) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[1]) == 0) { // Bill
-                        if (currentObstacles[i].xPos < 95 && currentObstacles[i].xPos > 70 && player.yPos > 60) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[2]) == 0) { // Cell_Phone
-                        if (currentObstacles[i].xPos < 95 && currentObstacles[i].xPos > 70 && player.yPos > 60) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[3]) == 0) { // Clock
-                        if (currentObstacles[i].xPos < 100 && currentObstacles[i].xPos > 70 && player.yPos > 60) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[4]) == 0) { // books
-                        if (currentObstacles[i].xPos < 110 && currentObstacles[i].xPos > 50 && player.yPos > 40) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[5]) == 0) { // Thunder can have y
-                        if (currentObstacles[i].xPos < 100 && currentObstacles[i].xPos > 50 && player.yPos > currentObstacles[i].yPos-100 && player.yPos < currentObstacles[i].yPos+0) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[6]) == 0) { // paper1
-                        if (currentObstacles[i].xPos < 95 && currentObstacles[i].xPos > 70 && player.yPos > 60) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[7]) == 0) { // Application
-                        if (currentObstacles[i].xPos < 100 && currentObstacles[i].xPos > 70 && player.yPos > 60) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[8]) == 0) { // messages can have y
-                        if (currentObstacles[i].xPos < 100 && currentObstacles[i].xPos > 50 && player.yPos > currentObstacles[i].yPos-100 && player.yPos < currentObstacles[i].yPos+0) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[9]) == 0) { // News can have y
-                        if (currentObstacles[i].xPos < 100 && currentObstacles[i].xPos > 50 && player.yPos > currentObstacles[i].yPos-100 && player.yPos < currentObstacles[i].yPos+0) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[10]) == 0) { // Email can have y
-                        if (currentObstacles[i].xPos < 100 && currentObstacles[i].xPos > 50 && player.yPos > currentObstacles[i].yPos-90 && player.yPos < currentObstacles[i].yPos-10) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-
-                    } else if (strcmp(currentObstacles[i].imageName, obstacleImages[11]) == 0) { // Phone2
-                        if (currentObstacles[i].xPos < 95 && currentObstacles[i].xPos > 70 && player.yPos > 60) {
-                            collideObstacle(&currentObstacles[i], &player, &screen);
-                            if(player.stressIndex > 5){
-                                checkScore(&score, &maxScore);
-                            }
-                        }
-                    }
+            // The player is always drawn at x = 30, so its box only moves vertically
+            FEHHitbox playerBox = {30 + playerHitbox.left, player.yPos + playerHitbox.top, 30 + playerHitbox.right, player.yPos + playerHitbox.bottom};
+            int hits[64];
+
+            // Check obstacles: boxes find the candidates, then the sprites' pixels must actually touch
+            int hitCount = obstacleBroadphase.Query(playerBox, hits, 64);
+            for(int i = 0; i < hitCount; i++){
+                int id = hits[i];
+                if(!player.image->Overlaps(30, player.yPos, currentObstacles.Sprite(currentObstacles.kind[id]), floor(currentObstacles.x[id]), currentObstacles.y[id])){
+                    continue;
+                }
+                collideObstacle(&currentObstacles, id, &player, &screen);
+                if(player.stressIndex > 5){
+                    checkScore(&progress->score, &progress->maxScore);
                 }
             }
 
             // Check objects
-            for (int i = 0; i < 15; i++) {
-                if (currentObjects[i].generated) {
-                    if (strcmp(currentObjects[i].imageName, objectImages[0]) == 0) { // Bed
-                        if (currentObjects[i].xPos < 100 && currentObjects[i].xPos > 30 && player.yPos > 60) {
-                            collideObject(&currentObjects[i], &player);
-                        }
-
-                    } else if (strcmp(currentObjects[i].imageName, objectImages[1]) == 0) { // Heart can have y
-                        if (currentObjects[i].xPos < 100 && currentObjects[i].xPos > 50 && player.yPos > currentObjects[i].yPos-90 && player.yPos < currentObjects[i].yPos-10) {
-                            collideObject(&currentObjects[i], &player);
-                        }
-
-                    } else if (strcmp(currentObjects[i].imageName, objectImages[2]) == 0) { // Coffee can have y
-                        if (currentObjects[i].xPos < 100 && currentObjects[i].xPos > 50 && player.yPos > currentObjects[i].yPos-90 && player.yPos < currentObjects[i].yPos-10) {
-                            collideObject(&currentObjects[i], &player);
-                        }
-
-                    } else if (strcmp(currentObjects[i].imageName, objectImages[3]) == 0) { // Outside can have y
-                        if (currentObjects[i].xPos < 100 && currentObjects[i].xPos > 50 && player.yPos > currentObjects[i].yPos-100 && player.yPos < currentObjects[i].yPos+0) {
-                            collideObject(&currentObjects[i], &player);
-                        }
-
-                    } else if (strcmp(currentObjects[i].imageName, objectImages[4]) == 0) { // Sports can have y
-                        if (currentObjects[i].xPos < 100 && currentObjects[i].xPos > 50 && player.yPos > currentObjects[i].yPos-90 && player.yPos < currentObjects[i].yPos-10) {
-                            collideObject(&currentObjects[i], &player);
-                        }
-
-                    } else if (strcmp(currentObjects[i].imageName, objectImages[5]) == 0) { // Call can have y
-                        if (currentObjects[i].xPos < 100 && currentObjects[i].xPos > 50 && player.yPos > currentObjects[i].yPos-100 && player.yPos < currentObjects[i].yPos+0) {
-                            collideObject(&currentObjects[i], &player);
-                        }
-                        
-                    } else if (strcmp(currentObjects[i].imageName, objectImages[6]) == 0) { // Journal can have y
-                        if (currentObjects[i].xPos < 100 && currentObjects[i].xPos > 50 && player.yPos > currentObjects[i].yPos-100 && player.yPos < currentObjects[i].yPos+0) {
-                            collideObject(&currentObjects[i], &player);
-                        }
-                    }
+            hitCount = objectBroadphase.Query(playerBox, hits, 64);
+            for(int i = 0; i < hitCount; i++){
+                int id = hits[i];
+                if(!player.image->Overlaps(30, player.yPos, currentObjects.Sprite(currentObjects.kind[id]), floor(currentObjects.x[id]), currentObjects.y[id])){
+                    continue;
                 }
+                collideObject(&currentObjects, id, &player);
             }
 
+            return screen;
+        }
 
-        }else if(screen == 2){ // stats
-            // background
-            LCD.SetFontColor(LIGHTPINK);
-            LCD.FillRectangle(0,0,319,239);
-
-            // add text
-            LCD.SetFontColor(MAROON);
-            LCD.WriteAt("High Score:",70,120);
-            LCD.WriteAt((int)maxScore/100,210,120);
-
-            LCD.SetFontColor(MAROON);
-            LCD.WriteAt("Runs Played:",60,90);
-            LCD.WriteAt(runsPlayed,220,90);
-
-            LCD.SetFontColor(LIGHTCORAL);
-            LCD.WriteAt("Click anywhere to return",10,210);
-
-            float x_pos;
-            float y_pos;
+        void Draw(){
+            LCD.Phase("draw");
 
-            if(LCD.Touch(&x_pos, &y_pos, false)){
-                screen = 1;
-                released = false;
-            }
-            
-        }else if(screen == 3){ // credits
             // background
-            LCD.SetFontColor(LIGHTGOLDENRODYELLOW);
-            LCD.FillRectangle(0,0,319,239);
-
-            // Text
-            LCD.SetFontColor(BROWN);
-            LCD.WriteAt("An Escaping",100,20);
-            LCD.WriteAt("Meatball Production",50,35);
+            background->Draw(0,0);
 
-            FEHImage brand;
-            brand.Open("Logo2x.png");
-            brand.Draw(95,40);
-
-            LCD.WriteAt("Hannah Hofferberth and",25,164);    
-            LCD.WriteAt("Pierre van Zyl",60,180);    
-
-            LCD.SetFontColor(BURLYWOOD);
-            LCD.WriteAt("Click anywhere to return",10,210);
+            // score
+            LCD.SetFontColor(WHITESMOKE);
+            int placesLeft = 0;
+            if(((int)progress->score / 100) / 10 != 0){
+                placesLeft = 1;
+                if(((int)progress->score / 100) / 100 != 0){
+                    placesLeft = 2;
+                }
+                if(((int)progress->score / 100) / 1000 != 0){
+                    placesLeft = 3;
+                }
+            }
 
-            float x_pos;
-            float y_pos;
+            LCD.WriteAt((int)progress->score / 100, 290 - placesLeft * 10, 10);
 
-            if(LCD.Touch(&x_pos, &y_pos, false)){
-                screen = 1;
-                released = false;
-            }
             
-        }else if(screen == 4){ // info
-            // background
-            LCD.SetFontColor(LIGHTGREEN);
-            LCD.FillRectangle(0,0,319,239);
-
-            // Text
-            LCD.SetFontColor(DARKGREEN);
-            LCD.WriteAt("How to play:",85,10);
+            // sprites
+            // Ground
+            currGround[0].drawGround();
+            currGround[1].drawGround();
+            currGround[2].drawGround();
+            // Background
+            currBackground[0].drawGround();
+            currBackground[1].drawGround();
+            currBackground[2].drawGround();
+            // Player
+            player.drawChar();
 
-            // Actual instructions
-            instructions.Draw(45, 40);
+            // Jump bar
+            bar.drawBar(player.stressIndex);
 
-            LCD.SetFontColor(GREEN);
-            LCD.WriteAt("Click anywhere to return",10,215);
+            // Objects, then obstacles
+            currentObjects.Draw();
+            currentObstacles.Draw();
+        }
+};
 
-            float x_pos;
-            float y_pos;
+/* Game over screen (6)
 
-            if(LCD.Touch(&x_pos, &y_pos, false)){
-                screen = 1;
-                released = false;
-            }
-            
-        }else if(screen == 6){ // game over
-            // background
-            LCD.SetFontColor(DARKRED);
-            LCD.FillRectangle(0,0,319,239);
+Variables:
+- progress holds the score of the run that just ended and the high score
+- ui holds the text and the reminder shown under the scores
 
-            // Text
-            LCD.SetFontColor(WHITE);
-            LCD.WriteAt("Game Over!",100,20);
-            LCD.WriteAt("Score: " ,70,50);
-            LCD.WriteAt((int)score/100 ,200,50);
-            LCD.WriteAt("High Score: " ,55,82);
-            LCD.WriteAt((int)maxScore/100 ,205,82);
+Functions:
+- Enter loads the reminder, fills in the scores and redraws the whole screen
+- Update counts the run and returns to the menu when clicked
+- Draw redraws whatever changed
+*/
+class GameOverScene : public FEHScene{
+    private:
+        Progress *progress;
+        FEHWidgetTree ui{DARKRED};
+        FEHLabel title{100, 20, "Game Over!", WHITE};
+        FEHLabel scoreText{70, 50, "Score: ", WHITE};
+        FEHLabel score{200, 50, "0", WHITE, 8};
+        FEHLabel highScoreText{55, 82, "High Score: ", WHITE};
+        FEHLabel highScore{205, 82, "0", WHITE, 8};
+        FEHPicture reminder{20, 130};
+        FEHLabel returnText{15, 210, "Click to return to menu", WHITE};
 
-            reminder.Draw(20, 130);
+    public:
+        GameOverScene(Progress *p){
+            progress = p;
+            ui.Add(&title);
+            ui.Add(&scoreText);
+            ui.Add(&score);
+            ui.Add(&highScoreText);
+            ui.Add(&highScore);
+            ui.Add(&reminder);
+            ui.Add(&returnText);
+        }
 
-            LCD.SetFontColor(WHITE);
-            LCD.WriteAt("Click to return to menu",15,210);
+        void Enter(){
+            reminder.SetImage(assets.Load("EndReminder.png"));
+            score.SetText((int)progress->score/100);
+            highScore.SetText((int)progress->maxScore/100);
+            ui.Invalidate();
+        }
 
+        int Update(){
             float x_pos;
             float y_pos;
 
             if(LCD.Touch(&x_pos, &y_pos, false)){
-                screen = 1;
-                released = false;
-                resetTime = true;
+                progress->runsPlayed++;
+                return 1;
             }
-            
+            return FEH_SCENE_STAY;
         }
-        
 
-        LCD.Update();
-        // Never end
-    }
+        void Draw(){
+            ui.Draw();
+        }
+};
+
+/* Main method
+Purpose: Runs the game; each screen is a scene, details in comments throughout
+Written by both Hannah and Pierre
+*/
+int main()
+{
+    Progress progress;
+
+    // 1: menu, 2: stats, 3: credits, 4: instructions, 5: game, 6: game over
+    MenuScene menu;
+    StatsScene stats(&progress);
+    CreditsScene credits;
+    InfoScene info;
+    GameScene game(&progress);
+    GameOverScene gameOver(&progress);
+
+    FEHSceneManager screens;
+    screens.Add(1, &menu);
+    screens.Add(2, &stats);
+    screens.Add(3, &credits);
+    screens.Add(4, &info);
+    screens.Add(5, &game);
+    screens.Add(6, &gameOver);
+
+    // Never ends
+    screens.Run(1);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,500 @@
+/// @file FEHAlloc.cpp
+/// @brief Heap allocation counts and tracking, taken by standing in for the allocator's entry points
+/// @note The entry points are only replaced when built with FEH_TRACK_ALLOC defined (make TRACK_ALLOC=1);
+/// otherwise nothing is counted, and the allocator stays the C library's for sanitizers and valgrind to see
+
+#include "FEHAlloc.h"
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __GLIBC__
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+// With glibc every allocation is seen through malloc() and its relatives; elsewhere only through C++ new
+#if defined(FEH_TRACK_ALLOC) && defined(__GLIBC__)
+#define FEH_ALLOC_MALLOC
+#elif defined(FEH_TRACK_ALLOC)
+#define FEH_ALLOC_NEW
+#endif
+
+// The recorder and render threads allocate too
+static std::atomic<long> count(0);
+static std::atomic<long> bytes(0);
+
+// Call sites are told apart by this many return addresses, starting at the caller of the allocator
+#define SITE_DEPTH 6
+// Sites kept; allocations from any more share the last one
+#define MAX_SITES 4096
+// Frames whose counts are kept, from the one tracking started on
+#define MAX_FRAMES 65536
+
+struct Site
+{
+	void *stack[SITE_DEPTH];
+	int depth;
+	long count, bytes;
+	int first, last, frames;
+};
+
+static std::atomic<bool> tracking(false);
+static std::atomic<int> frame(0);
+static int startFrame;
+static Site *sites;
+static int siteCount;
+static int *frameCounts;
+
+// Held while the tables above change; a spin lock, since a mutex could allocate
+static std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+// Set while this thread is inside the tracker, so what it allocates itself (the stack walk, printing) isn't tracked
+static thread_local bool inside = false;
+
+#ifdef FEH_ALLOC_MALLOC
+
+// The program's own malloc() takes the place of the C library's for every caller, C++ new included;
+// glibc keeps its allocator reachable under these names
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t n, size_t size);
+extern "C" void *__libc_realloc(void *p, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+
+static void *rawCalloc(size_t n, size_t size)
+{
+	return __libc_calloc(n, size);
+}
+
+#else
+
+static void *rawCalloc(size_t n, size_t size)
+{
+	return calloc(n, size);
+}
+
+#endif
+
+static void track(size_t size, void *caller);
+
+// Always inlined, so the allocator's entry point is the only frame between its caller and track()
+__attribute__((always_inline)) static inline void counted(size_t size, void *caller)
+{
+	count.fetch_add(1, std::memory_order_relaxed);
+	bytes.fetch_add((long)size, std::memory_order_relaxed);
+	if (tracking.load(std::memory_order_relaxed) && !inside)
+	{
+		track(size, caller);
+	}
+}
+
+static unsigned hashStack(void *const *stack, int depth)
+{
+	unsigned h = 2166136261u;
+	for (int i = 0; i < depth; i++)
+	{
+		h = (h ^ (unsigned)((size_t)stack[i] >> 2)) * 16777619u;
+	}
+	return h;
+}
+
+// Kept out of line so the stack it walks always starts the same way: here, then the allocator's entry point
+__attribute__((noinline)) static void track(size_t size, void *caller)
+{
+	inside = true;
+
+	void *stack[SITE_DEPTH + 2];
+	int depth;
+#ifdef __GLIBC__
+	depth = backtrace(stack, SITE_DEPTH + 2) - 2;
+	if (depth > 0)
+	{
+		memmove(stack, stack + 2, depth * sizeof(void *));
+	}
+	else
+	{
+		stack[0] = caller;
+		depth = 1;
+	}
+#else
+	stack[0] = caller;
+	depth = 1;
+#endif
+
+	int f = frame.load(std::memory_order_relaxed);
+	unsigned h = hashStack(stack, depth);
+
+	while (busy.test_and_set(std::memory_order_acquire))
+	{
+	}
+
+	// Open addressing; once the table is nearly full, new sites go in the last slot
+	Site *site = NULL;
+	if (siteCount < MAX_SITES - 1)
+	{
+		for (unsigned i = h % (MAX_SITES - 1);; i = (i + 1) % (MAX_SITES - 1))
+		{
+			Site *s = &sites[i];
+			if (s->depth == 0)
+			{
+				memcpy(s->stack, stack, depth * sizeof(void *));
+				s->depth = depth;
+				s->first = f;
+				s->last = f - 1;
+				siteCount++;
+				site = s;
+				break;
+			}
+			if (s->depth == depth && memcmp(s->stack, stack, depth * sizeof(void *)) == 0)
+			{
+				site = s;
+				break;
+			}
+		}
+	}
+	else
+	{
+		site = &sites[MAX_SITES - 1];
+		if (site->depth == 0)
+		{
+			site->depth = -1;
+			site->first = f;
+			site->last = f - 1;
+		}
+	}
+	site->count++;
+	site->bytes += (long)size;
+	if (site->last != f)
+	{
+		site->last = f;
+		site->frames++;
+	}
+	if (f - startFrame >= 0 && f - startFrame < MAX_FRAMES)
+	{
+		frameCounts[f - startFrame]++;
+	}
+
+	busy.clear(std::memory_order_release);
+	inside = false;
+}
+
+bool FEHAlloc::Available()
+{
+#ifdef FEH_TRACK_ALLOC
+	return true;
+#else
+	return false;
+#endif
+}
+
+long FEHAlloc::Count()
+{
+	return count.load(std::memory_order_relaxed);
+}
+
+long FEHAlloc::Bytes()
+{
+	return bytes.load(std::memory_order_relaxed);
+}
+
+void FEHAlloc::Track(bool on)
+{
+	if (!on || !Available())
+	{
+		tracking = false;
+		return;
+	}
+
+	inside = true;
+	if (!sites)
+	{
+		sites = (Site *)rawCalloc(MAX_SITES, sizeof(Site));
+		frameCounts = (int *)rawCalloc(MAX_FRAMES, sizeof(int));
+	}
+	else
+	{
+		memset(sites, 0, MAX_SITES * sizeof(Site));
+		memset(frameCounts, 0, MAX_FRAMES * sizeof(int));
+	}
+	siteCount = 0;
+	startFrame = frame;
+#ifdef __GLIBC__
+	// The first stack walk loads the unwinder, which allocates
+	void *warm[2];
+	backtrace(warm, 2);
+#endif
+	inside = false;
+	tracking = sites && frameCounts;
+}
+
+bool FEHAlloc::Tracking()
+{
+	return tracking;
+}
+
+void FEHAlloc::Frame(int f)
+{
+	frame.store(f, std::memory_order_relaxed);
+}
+
+// Where a site's allocations are charged to: the first return address outside the C and C++ libraries,
+// so that operator new and std::string are seen through to the code that used them
+static void *siteAddress(const Site &site)
+{
+#ifdef __GLIBC__
+	Dl_info info;
+	for (int i = 0; i < site.depth; i++)
+	{
+		if (dladdr(site.stack[i], &info) && info.dli_fname &&
+			(strstr(info.dli_fname, "libstdc++") || strstr(info.dli_fname, "libc.so") || strstr(info.dli_fname, "libgcc")))
+		{
+			continue;
+		}
+		return site.stack[i];
+	}
+#endif
+	return site.stack[0];
+}
+
+// An address as function and module offset (which addr2line takes), or just the address where that can't be asked
+static void describe(void *address, char *out, size_t length)
+{
+#ifdef __GLIBC__
+	Dl_info info;
+	if (dladdr(address, &info) && info.dli_fname)
+	{
+		const char *module = strrchr(info.dli_fname, '/') ? strrchr(info.dli_fname, '/') + 1 : info.dli_fname;
+		long offset = (long)((char *)address - (char *)info.dli_fbase);
+		if (info.dli_sname)
+		{
+			int status;
+			char *name = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+			snprintf(out, length, "%s (%s+0x%lx)", status == 0 ? name : info.dli_sname, module, offset);
+			free(name);
+		}
+		else
+		{
+			snprintf(out, length, "%s+0x%lx", module, offset);
+		}
+		return;
+	}
+#endif
+	snprintf(out, length, "%p", address);
+}
+
+void FEHAlloc::Print()
+{
+	if (!sites)
+	{
+		return;
+	}
+	inside = true;
+	while (busy.test_and_set(std::memory_order_acquire))
+	{
+	}
+
+	int end = std::min(frame.load() - startFrame, MAX_FRAMES - 1);
+	int frames = end + 1;
+	long total = 0;
+	int idle = 0, worst = 0, lastAllocated = -1;
+	int *sorted = (int *)rawCalloc(frames > 0 ? frames : 1, sizeof(int));
+	for (int i = 0; i < frames; i++)
+	{
+		total += frameCounts[i];
+		idle += frameCounts[i] == 0;
+		if (frameCounts[i] > frameCounts[worst])
+		{
+			worst = i;
+		}
+		if (frameCounts[i] > 0)
+		{
+			lastAllocated = i;
+		}
+		if (sorted)
+		{
+			sorted[i] = frameCounts[i];
+		}
+	}
+	printf("Allocations on frames %d to %d: %ld in all\n", startFrame, startFrame + end, total);
+	if (sorted && frames > 0)
+	{
+		std::sort(sorted, sorted + frames);
+		printf("  per frame: median %d, 90th percentile %d, most %d (frame %d)\n", sorted[frames / 2], sorted[frames * 9 / 10], frameCounts[worst], startFrame + worst);
+	}
+	free(sorted);
+	printf("  %d of %d frames allocated nothing", idle, frames);
+	if (lastAllocated >= 0)
+	{
+		printf("; the last allocation was on frame %d", startFrame + lastAllocated);
+	}
+	printf("\n");
+
+	// Sites whose allocations are charged to the same place are shown as one, e.g. a function called from
+	// many places; its frames are the most any of them allocated on
+	Site *merged = (Site *)rawCalloc(MAX_SITES, sizeof(Site));
+	int used = 0;
+	for (int i = 0; merged && i < MAX_SITES; i++)
+	{
+		const Site &site = sites[i];
+		if (site.depth == 0)
+		{
+			continue;
+		}
+		void *address = site.depth > 0 ? siteAddress(site) : NULL;
+		int m = 0;
+		while (m < used && merged[m].stack[0] != address)
+		{
+			m++;
+		}
+		if (m == used)
+		{
+			merged[used] = site;
+			merged[used].stack[0] = address;
+			used++;
+			continue;
+		}
+		merged[m].count += site.count;
+		merged[m].bytes += site.bytes;
+		merged[m].first = std::min(merged[m].first, site.first);
+		merged[m].last = std::max(merged[m].last, site.last);
+		merged[m].frames = std::max(merged[m].frames, site.frames);
+	}
+
+	// Busiest first
+	std::sort(merged, merged + used, [](const Site &a, const Site &b) { return a.count > b.count; });
+	printf("  %10s %12s %8s %8s %8s  %s\n", "count", "bytes", "frames", "first", "last", "call site");
+	char name[512];
+	for (int i = 0; i < used && i < 20; i++)
+	{
+		const Site &site = merged[i];
+		if (site.depth < 0)
+		{
+			snprintf(name, sizeof(name), "(every site past the first %d)", MAX_SITES - 1);
+		}
+		else
+		{
+			describe(site.stack[0], name, sizeof(name));
+		}
+		printf("  %10ld %12ld %8d %8d %8d  %s\n", site.count, site.bytes, site.frames, site.first, site.last, name);
+	}
+	if (used > 20)
+	{
+		printf("  ... and %d more call sites\n", used - 20);
+	}
+	free(merged);
+
+	busy.clear(std::memory_order_release);
+	inside = false;
+}
+
+#if defined(FEH_ALLOC_MALLOC)
+
+extern "C" void *malloc(size_t size)
+{
+	counted(size, __builtin_return_address(0));
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t n, size_t size)
+{
+	counted(n * size, __builtin_return_address(0));
+	return __libc_calloc(n, size);
+}
+
+extern "C" void *realloc(void *p, size_t size)
+{
+	counted(size, __builtin_return_address(0));
+	return __libc_realloc(p, size);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size)
+{
+	counted(size, __builtin_return_address(0));
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size)
+{
+	counted(size, __builtin_return_address(0));
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **out, size_t alignment, size_t size)
+{
+	if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+	{
+		return EINVAL;
+	}
+	counted(size, __builtin_return_address(0));
+	void *p = __libc_memalign(alignment, size);
+	if (!p)
+	{
+		return ENOMEM;
+	}
+	*out = p;
+	return 0;
+}
+
+#elif defined(FEH_ALLOC_NEW)
+
+// Without a way to reach the C library's allocator underneath, only C++ allocations are counted
+void *operator new(size_t size)
+{
+	counted(size, __builtin_return_address(0));
+	void *p = malloc(size ? size : 1);
+	if (!p)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](size_t size)
+{
+	counted(size, __builtin_return_address(0));
+	void *p = malloc(size ? size : 1);
+	if (!p)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+	counted(size, __builtin_return_address(0));
+	return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+	counted(size, __builtin_return_address(0));
+	return malloc(size ? size : 1);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+#endif
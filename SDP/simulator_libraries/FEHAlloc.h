@@ -0,0 +1,35 @@
+#ifndef FEHALLOC_H
+#define FEHALLOC_H
+
+/// @brief Running totals of the heap allocations the whole program has made, and where and when they were made
+/// @note Only in builds made with make TRACK_ALLOC=1, which stand in for the allocator; other builds count nothing.
+/// With glibc (Linux) every malloc(), calloc(), realloc() and aligned allocation is then counted, which takes in
+/// C++ new as well as tigr's own allocations; elsewhere only C++ new is. FEHProfile reports them per frame, and
+/// FEHLCD turns tracking on, see FEHLCD::TrackAllocations().
+namespace FEHAlloc
+{
+	/// @brief Whether this build counts allocations at all
+	bool Available();
+
+	/// @brief Number of allocations made so far
+	long Count();
+
+	/// @brief Bytes asked for by those allocations
+	long Bytes();
+
+	/// @brief Start or stop noting the frame and call site of every allocation
+	/// @note Costs a stack walk per allocation while on, and stays off unless Available(). Call sites are named
+	/// best with the game linked -rdynamic
+	void Track(bool on);
+
+	/// @brief Whether tracking is on
+	bool Tracking();
+
+	/// @brief The frame that allocations are charged to from now on
+	void Frame(int frame);
+
+	/// @brief Print allocations per frame since tracking started, and the call sites that made the most
+	void Print();
+}
+
+#endif // FEHALLOC_H
@@ -0,0 +1,87 @@
+/// @file FEHArena.cpp
+/// @brief Scratch memory that is taken back all at once
+
+#include "FEHArena.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+FEHArena::FEHArena(size_t size)
+{
+	blocks = NULL;
+	cursor = end = NULL;
+	blockSize = size > 0 ? size : 1;
+	used = peak = capacity = 0;
+}
+
+FEHArena::~FEHArena()
+{
+	while (blocks)
+	{
+		Block *next = blocks->next;
+		free(blocks);
+		blocks = next;
+	}
+}
+
+bool FEHArena::Grow(size_t size)
+{
+	Block *block = (Block *)malloc(sizeof(Block) + size);
+	if (!block)
+	{
+		return false;
+	}
+	block->next = blocks;
+	block->size = size;
+	blocks = block;
+	cursor = (char *)(block + 1);
+	end = cursor + size;
+	capacity += size;
+	return true;
+}
+
+void *FEHArena::Allocate(size_t size, size_t align)
+{
+	uintptr_t at = ((uintptr_t)cursor + align - 1) & ~(uintptr_t)(align - 1);
+	if (!cursor || at + size > (uintptr_t)end)
+	{
+		// What is left of the current block is given up; the next reset gets it back
+		size_t needed = size + align;
+		if (!Grow(needed > blockSize ? needed : blockSize))
+		{
+			return NULL;
+		}
+		at = ((uintptr_t)cursor + align - 1) & ~(uintptr_t)(align - 1);
+	}
+
+	used += (char *)at + size - cursor;
+	if (used > peak)
+	{
+		peak = used;
+	}
+	cursor = (char *)at + size;
+	return (void *)at;
+}
+
+void FEHArena::Reset()
+{
+	if (blocks && blocks->next)
+	{
+		// One block the size of them all
+		size_t total = capacity;
+		while (blocks)
+		{
+			Block *next = blocks->next;
+			free(blocks);
+			blocks = next;
+		}
+		cursor = end = NULL;
+		capacity = 0;
+		Grow(total);
+	}
+	else if (blocks)
+	{
+		cursor = (char *)(blocks + 1);
+		end = cursor + blocks->size;
+	}
+	used = 0;
+}
@@ -0,0 +1,98 @@
+#ifndef FEHARENA_H
+#define FEHARENA_H
+
+#include <stddef.h>
+#include <new>
+
+/// @brief Scratch memory handed out by moving a pointer along, and taken back all at once
+/// @note FEHLCD owns one that it resets in every Update(), see FEHLCD::FrameArena(), and keeps its recorded draw calls
+/// in it (see FEHDrawList); anything else that only needs its memory until the end of the frame can take it from there
+/// instead of the heap. Not safe to use from more than one thread.
+class FEHArena
+{
+	public:
+		/// @param blockSize Bytes taken from the heap at a time, until a reset finds out how much a frame needs
+		FEHArena(size_t blockSize = 64 * 1024);
+
+		~FEHArena();
+
+		/// @brief Take memory that lasts until the next Reset()
+		/// @param size Bytes wanted
+		/// @param align Alignment wanted, a power of two
+		/// @return The memory, or NULL if the heap has none to give
+		void *Allocate(size_t size, size_t align = alignof(max_align_t));
+
+		/// @brief Take back everything handed out, keeping the memory for next time
+		/// @note If the memory came in more than one block, it is replaced by one block big enough for all of it,
+		/// so that a frame like the last one is served from one block without touching the heap
+		void Reset();
+
+		/// @brief Bytes handed out since the last Reset()
+		size_t Used() { return used; }
+
+		/// @brief Most bytes handed out between two resets
+		size_t Peak() { return peak; }
+
+		/// @brief Bytes taken from the heap and kept
+		size_t Capacity() { return capacity; }
+
+	private:
+		FEHArena(const FEHArena &);
+		FEHArena &operator=(const FEHArena &);
+
+		struct Block
+		{
+			Block *next;
+			size_t size;
+		};
+
+		/// @brief Put a block of at least size usable bytes in front, to allocate from
+		bool Grow(size_t size);
+
+		// Newest block first; memory is handed out from the newest one
+		Block *blocks;
+		char *cursor, *end;
+		size_t blockSize;
+		size_t used, peak, capacity;
+};
+
+/// @brief Lets standard containers take their memory from an FEHArena, e.g.
+/// `std::vector<int, FEHArenaAllocator<int>> hits(FEHArenaAllocator<int>(LCD.FrameArena()));`
+/// @note Memory is only given back when the arena is reset, so a container must not outlive that
+template <class T>
+class FEHArenaAllocator
+{
+	public:
+		typedef T value_type;
+
+		FEHArenaAllocator(FEHArena &arena) : arena(&arena) {}
+
+		template <class U>
+		FEHArenaAllocator(const FEHArenaAllocator<U> &other) : arena(other.arena) {}
+
+		T *allocate(size_t n)
+		{
+			void *p = arena->Allocate(n * sizeof(T), alignof(T));
+			if (!p)
+			{
+				throw std::bad_alloc();
+			}
+			return (T *)p;
+		}
+
+		void deallocate(T *, size_t) {}
+
+		template <class U>
+		bool operator==(const FEHArenaAllocator<U> &other) const { return arena == other.arena; }
+
+		template <class U>
+		bool operator!=(const FEHArenaAllocator<U> &other) const { return arena != other.arena; }
+
+	private:
+		template <class U>
+		friend class FEHArenaAllocator;
+
+		FEHArena *arena;
+};
+
+#endif // FEHARENA_H
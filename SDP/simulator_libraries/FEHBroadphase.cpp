@@ -0,0 +1,180 @@
+/// @file FEHBroadphase.cpp
+/// @brief Sweep-and-prune search for overlapping boxes
+
+#include "FEHBroadphase.h"
+
+FEHBroadphase::FEHBroadphase(int cap)
+{
+	capacity = cap > 0 ? cap : 1;
+
+	boxes = new FEHHitbox[capacity];
+	registered = new bool[capacity]();
+	slot = new unsigned char[capacity]();
+	order = new int[capacity];
+	lefts = new float[capacity];
+	added = new int[capacity];
+
+	count = 0;
+	addedCount = 0;
+	maxWidth = 0;
+}
+
+FEHBroadphase::~FEHBroadphase()
+{
+	delete[] boxes;
+	delete[] registered;
+	delete[] slot;
+	delete[] order;
+	delete[] lefts;
+	delete[] added;
+}
+
+void FEHBroadphase::Set(int id, FEHHitbox box)
+{
+	if (id < 0 || id >= capacity)
+	{
+		return;
+	}
+
+	boxes[id] = box;
+	if (!registered[id])
+	{
+		registered[id] = true;
+		// Ids still in order from a previous frame keep their place there
+		if (slot[id] == NOT_LISTED)
+		{
+			slot[id] = ADDED;
+			added[addedCount++] = id;
+		}
+	}
+}
+
+void FEHBroadphase::Remove(int id)
+{
+	if (id >= 0 && id < capacity)
+	{
+		registered[id] = false;
+	}
+}
+
+void FEHBroadphase::Clear()
+{
+	for (int i = 0; i < capacity; i++)
+	{
+		registered[i] = false;
+	}
+}
+
+void FEHBroadphase::Update()
+{
+	// Drop unregistered ids from the order, keeping the rest in their previous order
+	int n = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int id = order[i];
+		if (registered[id])
+		{
+			order[n++] = id;
+		}
+		else
+		{
+			slot[id] = NOT_LISTED;
+		}
+	}
+
+	// Append new ids; Remove() may have been called on them since Set()
+	for (int i = 0; i < addedCount; i++)
+	{
+		int id = added[i];
+		if (registered[id])
+		{
+			slot[id] = LISTED;
+			order[n++] = id;
+		}
+		else
+		{
+			slot[id] = NOT_LISTED;
+		}
+	}
+	addedCount = 0;
+	count = n;
+
+	// Insertion sort by left edge, which is nearly linear when the order barely changed
+	for (int i = 1; i < count; i++)
+	{
+		int id = order[i];
+		float left = boxes[id].left;
+		int j = i - 1;
+		while (j >= 0 && boxes[order[j]].left > left)
+		{
+			order[j + 1] = order[j];
+			j--;
+		}
+		order[j + 1] = id;
+	}
+
+	maxWidth = 0;
+	for (int i = 0; i < count; i++)
+	{
+		const FEHHitbox &b = boxes[order[i]];
+		lefts[i] = b.left;
+		if (b.right - b.left > maxWidth)
+		{
+			maxWidth = b.right - b.left;
+		}
+	}
+}
+
+int FEHBroadphase::Query(FEHHitbox box, int hits[], int maxHits)
+{
+	// Nothing whose left edge is at or before box.left - maxWidth can reach the box
+	float start = box.left - maxWidth;
+	int lo = 0, hi = count;
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (lefts[mid] <= start)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	int n = 0;
+	for (int i = lo; i < count && lefts[i] < box.right && n < maxHits; i++)
+	{
+		const FEHHitbox &b = boxes[order[i]];
+		if (b.right > box.left && b.top < box.bottom && b.bottom > box.top)
+		{
+			hits[n++] = order[i];
+		}
+	}
+
+	return n;
+}
+
+int FEHBroadphase::Pairs(int first[], int second[], int maxPairs)
+{
+	int n = 0;
+
+	// Sweep left to right; each box only needs to be checked against the boxes that start before it ends
+	for (int i = 0; i < count && n < maxPairs; i++)
+	{
+		const FEHHitbox &a = boxes[order[i]];
+		for (int j = i + 1; j < count && lefts[j] < a.right && n < maxPairs; j++)
+		{
+			const FEHHitbox &b = boxes[order[j]];
+			if (b.top < a.bottom && b.bottom > a.top)
+			{
+				first[n] = order[i];
+				second[n] = order[j];
+				n++;
+			}
+		}
+	}
+
+	return n;
+}
@@ -0,0 +1,85 @@
+#ifndef FEHBROADPHASE_H
+#define FEHBROADPHASE_H
+
+/// @brief Axis-aligned collision box
+/// @note Hitbox tables are given relative to the upper left corner of a sprite; queries take boxes in screen coordinates
+struct FEHHitbox
+{
+	float left, top, right, bottom;
+};
+
+/// @brief Sweep-and-prune broadphase along the x axis
+/// @note Boxes are kept sorted by their left edge. Since a side-scroller moves everything
+/// by about the same amount each frame, the order barely changes and re-sorting is close to linear.
+/// Queries then only look at the boxes whose x range can reach the query, instead of every box.
+class FEHBroadphase
+{
+	public:
+		/// @brief Create a broadphase for ids 0 to capacity - 1
+		/// @param capacity One more than the largest id that will be registered (e.g. FEHEntities::Capacity())
+		FEHBroadphase(int capacity);
+
+		~FEHBroadphase();
+
+		/// @brief Register a box, or move it if the id is already registered
+		/// @param id Id of the box's owner
+		/// @param box Box in screen coordinates
+		/// @note Call Update() after moving boxes and before querying
+		void Set(int id, FEHHitbox box);
+
+		/// @brief Unregister a box. Ids that are not registered are ignored
+		void Remove(int id);
+
+		/// @brief Unregister every box
+		/// @note The previous order is remembered, so clearing and re-registering every box each frame stays cheap
+		void Clear();
+
+		/// @brief Re-sort the registered boxes; required after Set(), Remove() or Clear()
+		void Update();
+
+		/// @brief Find every registered box that overlaps a box
+		/// @param box Box to test against, in screen coordinates
+		/// @param hits Receives the ids of the overlapping boxes, from left to right
+		/// @param maxHits Size of the hits array; the search stops once it is full
+		/// @return Number of ids written to hits
+		/// @note Boxes that only touch along an edge do not overlap
+		int Query(FEHHitbox box, int hits[], int maxHits);
+
+		/// @brief Find every pair of registered boxes that overlap each other
+		/// @param first Receives the first id of each pair
+		/// @param second Receives the second id of each pair
+		/// @param maxPairs Size of the first and second arrays; the search stops once they are full
+		/// @return Number of pairs written
+		int Pairs(int first[], int second[], int maxPairs);
+
+		/// @brief Number of registered boxes
+		int Count() { return count; }
+
+	private:
+		FEHBroadphase(const FEHBroadphase &);
+		FEHBroadphase &operator=(const FEHBroadphase &);
+
+		int capacity;
+
+		// Where an id is in the order list
+		enum Slot { NOT_LISTED, ADDED, LISTED };
+
+		// Boxes, registration flags and slots, indexed by id
+		FEHHitbox *boxes;
+		bool *registered;
+		unsigned char *slot;
+
+		// Registered ids in order of left edge, plus a copy of each left edge for binary searching
+		int *order;
+		float *lefts;
+		int count;
+
+		// Ids that were registered since the last Update(), not yet in order
+		int *added;
+		int addedCount;
+
+		// Widest registered box, so queries know how far left to start looking
+		float maxWidth;
+};
+
+#endif // FEHBROADPHASE_H
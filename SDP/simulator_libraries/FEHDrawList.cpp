@@ -0,0 +1,295 @@
+/// @file FEHDrawList.cpp
+/// @brief Draw calls replayed in parallel over horizontal bands
+
+#include "FEHDrawList.h"
+#include <limits.h>
+
+// Smallest band worth handing to a thread, and bands per thread so that a thread finishing early can take another
+#define MIN_BAND_HEIGHT 8
+#define BANDS_PER_THREAD 4
+
+// Calls reserved for the first frame, before there is a last one to go by
+#define FIRST_RESERVE 256
+
+FEHDrawList::FEHDrawList(int threads, FEHArena *arena)
+	: ownArena(4 * 1024), arena(arena ? arena : &ownArena), commands(FEHArenaAllocator<Command>(*this->arena))
+{
+	largest = FIRST_RESERVE;
+	this->threads = 1;
+	target = NULL;
+	bandHeight = 0;
+	bandCount = 0;
+	nextBand = 0;
+	finished = 0;
+	generation = 0;
+	stopping = false;
+	SetThreads(threads);
+}
+
+FEHDrawList::~FEHDrawList()
+{
+	StopWorkers();
+}
+
+void FEHDrawList::SetThreads(int threads)
+{
+	StopWorkers();
+	this->threads = threads > 1 ? threads : 1;
+	StartWorkers();
+}
+
+void FEHDrawList::Add(Command &c, Type type, int top, int bottom)
+{
+	c.type = type;
+	c.top = top;
+	c.bottom = bottom;
+	if (commands.capacity() == 0)
+	{
+		commands.reserve(largest);
+	}
+	commands.push_back(c);
+}
+
+void FEHDrawList::Forget()
+{
+	if (commands.size() > largest)
+	{
+		largest = commands.size();
+	}
+
+	// Swapped out rather than cleared, since the memory belongs to the arena from here on
+	Commands(FEHArenaAllocator<Command>(*arena)).swap(commands);
+	if (arena == &ownArena)
+	{
+		ownArena.Reset();
+	}
+}
+
+void FEHDrawList::Plot(int x, int y, TPixel color)
+{
+	Command c;
+	c.x = x;
+	c.y = y;
+	c.color = color;
+	Add(c, PLOT, y, y + 1);
+}
+
+void FEHDrawList::Line(int x0, int y0, int x1, int y1, TPixel color)
+{
+	Command c;
+	c.x = x0;
+	c.y = y0;
+	c.w = x1;
+	c.h = y1;
+	c.color = color;
+	Add(c, LINE, y0 < y1 ? y0 : y1, (y0 < y1 ? y1 : y0) + 1);
+}
+
+void FEHDrawList::Rect(int x, int y, int w, int h, TPixel color)
+{
+	Command c;
+	c.x = x;
+	c.y = y;
+	c.w = w;
+	c.h = h;
+	c.color = color;
+	Add(c, RECT, y, y + h);
+}
+
+void FEHDrawList::Fill(int x, int y, int w, int h, TPixel color)
+{
+	Command c;
+	c.x = x;
+	c.y = y;
+	c.w = w;
+	c.h = h;
+	c.color = color;
+	Add(c, FILL, y, y + h);
+}
+
+void FEHDrawList::Clear(TPixel color)
+{
+	// Nothing drawn before a clear can show through it
+	commands.clear();
+
+	Command c;
+	c.color = color;
+	Add(c, CLEAR, INT_MIN, INT_MAX);
+}
+
+void FEHDrawList::BlitAlpha(Tigr *src, int dx, int dy, int sx, int sy, int w, int h, float alpha)
+{
+	Command c;
+	c.src = src;
+	c.x = dx;
+	c.y = dy;
+	c.sx = sx;
+	c.sy = sy;
+	c.w = w;
+	c.h = h;
+	c.alpha = alpha;
+	Add(c, BLIT_ALPHA, dy, dy + h);
+}
+
+void FEHDrawList::BlitSubpixel(Tigr *src, float dx, float dy, int sx, int sy, int w, int h, float alpha)
+{
+	// tigrBlitSubpixel floors dy, so keeping it whole lets bands move it without rounding
+	int y = (int)dy;
+	if (y > dy)
+	{
+		y--;
+	}
+
+	Command c;
+	c.src = src;
+	c.fx = dx;
+	c.y = y;
+	c.sx = sx;
+	c.sy = sy;
+	c.w = w;
+	c.h = h;
+	c.alpha = alpha;
+	Add(c, BLIT_SUBPIXEL, y, y + h);
+}
+
+void FEHDrawList::Execute(Tigr *target)
+{
+	if (commands.empty())
+	{
+		return;
+	}
+
+	this->target = target;
+	if (threads == 1)
+	{
+		RunBand(0, target->h);
+		Forget();
+		return;
+	}
+
+	int bands = threads * BANDS_PER_THREAD;
+	bandHeight = (target->h + bands - 1) / bands;
+	if (bandHeight < MIN_BAND_HEIGHT)
+	{
+		bandHeight = MIN_BAND_HEIGHT;
+	}
+	bandCount = (target->h + bandHeight - 1) / bandHeight;
+	finished = 0;
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		nextBand = 0;
+		generation++;
+	}
+	wake.notify_all();
+
+	RunBands();
+
+	std::unique_lock<std::mutex> guard(lock);
+	done.wait(guard, [this]() { return finished == bandCount; });
+	Forget();
+}
+
+void FEHDrawList::RunBands()
+{
+	int band;
+	while ((band = nextBand++) < bandCount)
+	{
+		int top = band * bandHeight;
+		int bottom = top + bandHeight < target->h ? top + bandHeight : target->h;
+		RunBand(top, bottom);
+
+		if (++finished == bandCount)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			done.notify_one();
+		}
+	}
+}
+
+void FEHDrawList::RunBand(int top, int bottom)
+{
+	// A bitmap over just the band's rows: tigr clips to it, and everything moves up by top
+	Tigr band;
+	band.w = target->w;
+	band.h = bottom - top;
+	band.pix = target->pix + top * target->w;
+	band.handle = NULL;
+
+	for (size_t i = 0; i < commands.size(); i++)
+	{
+		const Command &c = commands[i];
+		if (c.bottom <= top || c.top >= bottom)
+		{
+			continue;
+		}
+
+		switch (c.type)
+		{
+		case PLOT:
+			tigrPlot(&band, c.x, c.y - top, c.color);
+			break;
+		case LINE:
+			tigrLine(&band, c.x, c.y - top, c.w, c.h - top, c.color);
+			break;
+		case RECT:
+			tigrRect(&band, c.x, c.y - top, c.w, c.h, c.color);
+			break;
+		case FILL:
+			tigrFill(&band, c.x, c.y - top, c.w, c.h, c.color);
+			break;
+		case CLEAR:
+			tigrClear(&band, c.color);
+			break;
+		case BLIT_ALPHA:
+			tigrBlitAlpha(&band, c.src, c.x, c.y - top, c.sx, c.sy, c.w, c.h, c.alpha);
+			break;
+		case BLIT_SUBPIXEL:
+			tigrBlitSubpixel(&band, c.src, c.fx, (float)(c.y - top), c.sx, c.sy, c.w, c.h, c.alpha);
+			break;
+		}
+	}
+}
+
+void FEHDrawList::StartWorkers()
+{
+	stopping = false;
+	for (int i = 1; i < threads; i++)
+	{
+		workers.push_back(std::thread(&FEHDrawList::Work, this));
+	}
+}
+
+void FEHDrawList::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	workers.clear();
+}
+
+void FEHDrawList::Work()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	int seen = generation;
+	while (true)
+	{
+		wake.wait(guard, [&]() { return stopping || generation != seen; });
+		if (stopping)
+		{
+			return;
+		}
+		seen = generation;
+
+		guard.unlock();
+		RunBands();
+		guard.lock();
+	}
+}
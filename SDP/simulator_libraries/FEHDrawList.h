@@ -0,0 +1,111 @@
+#ifndef FEHDRAWLIST_H
+#define FEHDRAWLIST_H
+
+#include "tigr.h"
+#include "FEHArena.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/// @brief Draw calls recorded for a frame, then run in parallel over horizontal bands of the target
+/// @note Every band runs the whole list in order, clipped to its own rows, so the result is the same
+/// pixel for pixel as drawing straight into the target. Calls that miss a band are skipped by their rows.
+/// Source bitmaps are only read by Execute(), so they must stay alive and unchanged until then.
+/// @note The recorded calls are kept in an arena, so a frame's worth of them is one allocation from it; after the first
+/// few frames, recording takes nothing from the heap.
+class FEHDrawList
+{
+	public:
+		/// @param threads Number of threads Execute() uses, counting the one that calls it
+		/// @param arena Arena to keep the recorded calls in, which must not be reset between recording and Execute(),
+		/// e.g. FEHLCD::FrameArena(). Without one, the list has its own and resets it after each Execute()
+		FEHDrawList(int threads = 1, FEHArena *arena = NULL);
+
+		~FEHDrawList();
+
+		/// @brief Change the number of threads Execute() uses, counting the one that calls it
+		void SetThreads(int threads);
+
+		/// @brief Number of threads Execute() uses
+		int Threads() { return threads; }
+
+		/// @name Recording
+		/// @brief Same as the tigr function of the same name, drawing into the target of the next Execute()
+		///@{
+		void Plot(int x, int y, TPixel color);
+		void Line(int x0, int y0, int x1, int y1, TPixel color);
+		void Rect(int x, int y, int w, int h, TPixel color);
+		void Fill(int x, int y, int w, int h, TPixel color);
+		void Clear(TPixel color);
+		void BlitAlpha(Tigr *src, int dx, int dy, int sx, int sy, int w, int h, float alpha);
+		void BlitSubpixel(Tigr *src, float dx, float dy, int sx, int sy, int w, int h, float alpha);
+		///@}
+
+		/// @brief Run every recorded call on a bitmap, in order, then forget them
+		void Execute(Tigr *target);
+
+		/// @brief Number of calls recorded since the last Execute()
+		int Count() { return (int)commands.size(); }
+
+	private:
+		FEHDrawList(const FEHDrawList &);
+		FEHDrawList &operator=(const FEHDrawList &);
+
+		enum Type { PLOT, LINE, RECT, FILL, CLEAR, BLIT_ALPHA, BLIT_SUBPIXEL };
+
+		struct Command
+		{
+			Type type;
+			// Rows from top up to but not including bottom may be drawn on
+			int top, bottom;
+			// Position and size, or the two ends of a line; y is already floored for subpixel blits
+			int x, y, w, h;
+			int sx, sy;
+			float fx, alpha;
+			TPixel color;
+			Tigr *src;
+		};
+
+		typedef std::vector<Command, FEHArenaAllocator<Command> > Commands;
+
+		void Add(Command &c, Type type, int top, int bottom);
+
+		/// @brief Drop the recorded calls along with the memory that held them
+		void Forget();
+
+		/// @brief Run every command on rows top to bottom - 1 of the target
+		void RunBand(int top, int bottom);
+
+		/// @brief Take bands of the current Execute() until none are left
+		void RunBands();
+
+		void StartWorkers();
+		void StopWorkers();
+		void Work();
+
+		// Declared in this order so that the arena exists before commands takes memory from it
+		FEHArena ownArena;
+		FEHArena *arena;
+		Commands commands;
+
+		// Most calls recorded between two Execute()s, reserved up front so the list grows at most once a frame
+		size_t largest;
+
+		int threads;
+
+		// The Execute() being run; nextBand hands out bands and finished counts them back in
+		Tigr *target;
+		int bandHeight, bandCount;
+		std::atomic<int> nextBand, finished;
+
+		// Workers sleep until generation changes, Execute() sleeps until finished reaches bandCount
+		std::vector<std::thread> workers;
+		std::mutex lock;
+		std::condition_variable wake, done;
+		int generation;
+		bool stopping;
+};
+
+#endif // FEHDRAWLIST_H
@@ -0,0 +1,177 @@
+/// @file FEHEntities.cpp
+/// @brief Structure-of-arrays storage for moving sprites
+
+#include "FEHEntities.h"
+
+FEHEntities::FEHEntities(int cap, int kinds)
+{
+	capacity = cap > 0 ? cap : 1;
+	maxKinds = kinds > 0 ? kinds : 1;
+	kindCount = 0;
+	words = (capacity + 63) / 64;
+
+	x = new float[capacity];
+	y = new float[capacity];
+	vx = new float[capacity];
+	kind = new int[capacity];
+	alive = new uint64_t[words];
+	freeList = new int[capacity];
+	kindSprites = new FEHImage[maxKinds];
+	kindHitboxes = new FEHHitbox[maxKinds];
+
+	Clear();
+}
+
+FEHEntities::~FEHEntities()
+{
+	delete[] x;
+	delete[] y;
+	delete[] vx;
+	delete[] kind;
+	delete[] alive;
+	delete[] freeList;
+	delete[] kindSprites;
+	delete[] kindHitboxes;
+}
+
+int FEHEntities::AddKind(const FEHImage &spr, FEHHitbox box)
+{
+	if (kindCount == maxKinds)
+	{
+		return -1;
+	}
+
+	kindSprites[kindCount] = spr;
+	kindHitboxes[kindCount] = box;
+	return kindCount++;
+}
+
+int FEHEntities::Spawn(int k, float px, float py, float pvx)
+{
+	if (freeCount == 0 || k < 0 || k >= kindCount)
+	{
+		return -1;
+	}
+
+	int id = freeList[--freeCount];
+	x[id] = px;
+	y[id] = py;
+	vx[id] = pvx;
+	kind[id] = k;
+	alive[id >> 6] |= (uint64_t)1 << (id & 63);
+	count++;
+
+	return id;
+}
+
+void FEHEntities::Despawn(int id)
+{
+	if (!Alive(id))
+	{
+		return;
+	}
+
+	alive[id >> 6] &= ~((uint64_t)1 << (id & 63));
+	freeList[freeCount++] = id;
+	count--;
+}
+
+void FEHEntities::Clear()
+{
+	for (int w = 0; w < words; w++)
+	{
+		alive[w] = 0;
+	}
+
+	// Push ids in reverse so the first spawns get the lowest ids
+	freeCount = 0;
+	for (int id = capacity - 1; id >= 0; id--)
+	{
+		freeList[freeCount++] = id;
+	}
+	count = 0;
+}
+
+void FEHEntities::ClearKinds()
+{
+	Clear();
+	for (int k = 0; k < kindCount; k++)
+	{
+		kindSprites[k] = FEHImage();
+	}
+	kindCount = 0;
+}
+
+void FEHEntities::Draw()
+{
+	for (int w = 0; w < words; w++)
+	{
+		uint64_t bits = alive[w];
+		while (bits)
+		{
+			int id = (w << 6) + __builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			kindSprites[kind[id]].DrawSubpixel(x[id], y[id]);
+		}
+	}
+}
+
+void FEHEntities::Update(float scroll, float cullX, FEHBroadphase &broadphase)
+{
+	broadphase.Clear();
+	for (int w = 0; w < words; w++)
+	{
+		uint64_t bits = alive[w];
+		while (bits)
+		{
+			int id = (w << 6) + __builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			x[id] += vx[id] - scroll;
+			if (x[id] < cullX)
+			{
+				Despawn(id);
+				continue;
+			}
+
+			const FEHHitbox &hb = kindHitboxes[kind[id]];
+			FEHHitbox box = {x[id] + hb.left, y[id] + hb.top, x[id] + hb.right, y[id] + hb.bottom};
+			broadphase.Set(id, box);
+		}
+	}
+	broadphase.Update();
+}
+
+int FEHEntities::First()
+{
+	return Next(-1);
+}
+
+int FEHEntities::Next(int id)
+{
+	id++;
+	if (id >= capacity)
+	{
+		return -1;
+	}
+
+	// Mask off ids at or below the current one in the first word, then scan forward
+	int w = id >> 6;
+	uint64_t bits = alive[w] & (~(uint64_t)0 << (id & 63));
+	while (!bits)
+	{
+		if (++w >= words)
+		{
+			return -1;
+		}
+		bits = alive[w];
+	}
+
+	return (w << 6) + __builtin_ctzll(bits);
+}
+
+bool FEHEntities::Alive(int id)
+{
+	return id >= 0 && id < capacity && (alive[id >> 6] >> (id & 63)) & 1;
+}
@@ -0,0 +1,112 @@
+#ifndef FEHENTITIES_H
+#define FEHENTITIES_H
+
+#include <stdint.h>
+#include "FEHImages.h"
+#include "FEHBroadphase.h"
+
+/// @brief Fixed-capacity store for many moving sprites (obstacles, pickups, ...)
+/// @note Entities are kept as parallel arrays indexed by entity id, so one pass over the
+/// store touches only the fields it needs. Spawning and despawning are O(1) and never allocate.
+/// @note Each entity is of a kind, registered once with AddKind(). Entities of a kind share its sprite and hitbox.
+class FEHEntities
+{
+	public:
+		/// @brief Create a store that can hold up to capacity live entities
+		/// @param capacity Maximum number of entities alive at the same time
+		/// @param maxKinds Maximum number of kinds that can be registered with AddKind()
+		FEHEntities(int capacity, int maxKinds = 16);
+
+		~FEHEntities();
+
+		/// @brief Register a kind of entity
+		/// @param sprite Opened image drawn for entities of this kind; shared with the caller, not copied
+		/// @param hitbox Collision box relative to the upper left corner of the sprite
+		/// @return The new kind, numbered from 0 in the order kinds are added, or -1 if maxKinds was reached
+		int AddKind(const FEHImage &sprite, FEHHitbox hitbox);
+
+		/// @brief Add an entity to the store
+		/// @param kind Kind returned by AddKind()
+		/// @param x X coordinate of upper left corner of the entity's sprite
+		/// @param y Y coordinate of upper left corner of the entity's sprite
+		/// @param vx Horizontal speed in pixels per Update(), on top of the world scroll
+		/// @return The new entity's id, or -1 if the store is full or the kind does not exist
+		int Spawn(int kind, float x, float y, float vx = 0);
+
+		/// @brief Remove an entity; its id may be handed out again by the next Spawn()
+		/// @param id Id returned by Spawn(). Ids that are not alive are ignored
+		void Despawn(int id);
+
+		/// @brief Remove every entity; registered kinds are kept
+		void Clear();
+
+		/// @brief Remove every entity and every kind, letting go of the kinds' sprites
+		void ClearKinds();
+
+		/// @brief Move and cull every live entity, and fill a broadphase with the survivors' hitboxes, in a single pass
+		/// @param scroll Distance the world scrolled this frame, subtracted from every x
+		/// @param cullX Entities that move left of this x coordinate are despawned
+		/// @param broadphase Broadphase whose contents are replaced; its ids are entity ids, so it needs at least Capacity() ids
+		void Update(float scroll, float cullX, FEHBroadphase &broadphase);
+
+		/// @brief Draw every live entity at its current position
+		void Draw();
+
+		/// @name Iteration
+		///@{
+		/// @brief Visit live entities in id order: for (int i = e.First(); i >= 0; i = e.Next(i))
+		/// @note It is safe to Despawn() the current id while iterating
+		int First();
+		int Next(int id);
+		///@}
+
+		/// @brief Check if an id refers to a live entity
+		bool Alive(int id);
+
+		/// @brief Number of live entities
+		int Count() { return count; }
+
+		/// @brief Maximum number of live entities
+		int Capacity() { return capacity; }
+
+		/// @brief Sprite of a kind
+		FEHImage &Sprite(int kind) { return kindSprites[kind]; }
+
+		/// @brief Hitbox of a kind, relative to the upper left corner of its sprite
+		FEHHitbox Hitbox(int kind) { return kindHitboxes[kind]; }
+
+		/// @brief Number of registered kinds
+		int Kinds() { return kindCount; }
+
+		/// @name Entity fields, indexed by id
+		/// @note Only meaningful for live ids. Positions may be changed freely; use Spawn() and Despawn() for everything else
+		///@{
+		float *x;
+		float *y;
+		float *vx;
+		int *kind;
+		///@}
+
+	private:
+		FEHEntities(const FEHEntities &);
+		FEHEntities &operator=(const FEHEntities &);
+
+		int capacity;
+		int count;
+		int words;
+
+		// One bit per id, set while the entity is alive
+		uint64_t *alive;
+
+		// Stack of ids that are free to spawn into
+		int *freeList;
+		int freeCount;
+
+		// Registered kinds
+		FEHImage *kindSprites;
+		FEHHitbox *kindHitboxes;
+		int kindCount;
+		int maxKinds;
+};
+
+#endif // FEHENTITIES_H
@@ -6,9 +6,14 @@
 
 #include <FEHImages.h>
 #include "FEHUtility.h"
+#include "FEHDrawList.h"
+#include <algorithm>
 
 void FEHImage::Open(const char *filename)
 {
+	// Let go of the previously opened image, if any
+	Release();
+
 	// Check file extension, if it is a .pic file, use OpenPic
 	if (strstr(filename, ".pic") != NULL || strstr(filename, ".PIC") != NULL)
 	{
@@ -32,10 +37,61 @@ void FEHImage::Open(const char *filename)
 	}
 
 	// Check for images that are too large
-	if (tigr->w > LCD_WIDTH || tigr->h > LCD_HEIGHT)
+	if (tigr->w > LCD.Width() || tigr->h > LCD.Height())
+	{
+		std::cout << CONSOLE_ERR("Image [" << CONSOLE_BLUE(filename) << "] is too large! Please use an image smaller than " << CONSOLE_GREEN(LCD.Width()) << "x" << CONSOLE_GREEN(LCD.Height()) << "\n");
+	}
+
+	BuildMask();
+	refs = new int(1);
+}
+
+FEHImage::FEHImage(const FEHImage &other)
+	: tigr(other.tigr), mask(other.mask), maskStride(other.maskStride),
+	  maskLeft(other.maskLeft), maskTop(other.maskTop), maskRight(other.maskRight), maskBottom(other.maskBottom),
+	  refs(other.refs)
+{
+	if (refs)
+	{
+		(*refs)++;
+	}
+}
+
+FEHImage &FEHImage::operator=(const FEHImage &other)
+{
+	if (refs != other.refs || tigr != other.tigr)
+	{
+		Release();
+		tigr = other.tigr;
+		mask = other.mask;
+		maskStride = other.maskStride;
+		maskLeft = other.maskLeft;
+		maskTop = other.maskTop;
+		maskRight = other.maskRight;
+		maskBottom = other.maskBottom;
+		refs = other.refs;
+		if (refs)
+		{
+			(*refs)++;
+		}
+	}
+	return *this;
+}
+
+void FEHImage::Release()
+{
+	// Handles without a count never opened an image successfully, so they own nothing
+	if (refs && --*refs == 0)
 	{
-		std::cout << CONSOLE_ERR("Image [" << CONSOLE_BLUE(filename) << "] is too large! Please use an image smaller than " << CONSOLE_GREEN(LCD_WIDTH) << "x" << CONSOLE_GREEN(LCD_HEIGHT) << "\n");
+		// Recorded draw calls may still read the bitmap
+		LCD.Flush();
+		tigrFree(tigr);
+		delete[] mask;
+		delete refs;
 	}
+	tigr = NULL;
+	mask = NULL;
+	refs = NULL;
 }
 
 // Legacy function to load .pic files
@@ -81,10 +137,128 @@ void FEHImage::Draw(int x, int y)
 	if (tigr)
 	{
 		// Draw image to LCD
-		tigrBlitAlpha(LCD.screen, tigr, x, y, 0, 0, tigr->w, tigr->h, 1.0);
+		if (LCD.drawList)
+		{
+			LCD.drawList->BlitAlpha(tigr, x, y, 0, 0, tigr->w, tigr->h, 1.0);
+		}
+		else
+		{
+			tigrBlitAlpha(LCD.screen, tigr, x, y, 0, 0, tigr->w, tigr->h, 1.0);
+		}
 	}
 	else
 	{
 		std::cout << CONSOLE_ERR("FEHImage::Draw called without a file open.") << std::endl;
 	}
 }
+
+// x,y are top left location of where to draw picture, x may fall between pixels
+void FEHImage::DrawSubpixel(float x, float y)
+{
+	if (tigr)
+	{
+		// Draw image to LCD, blending across the pixel boundary
+		if (LCD.drawList)
+		{
+			LCD.drawList->BlitSubpixel(tigr, x, y, 0, 0, tigr->w, tigr->h, 1.0);
+		}
+		else
+		{
+			tigrBlitSubpixel(LCD.screen, tigr, x, y, 0, 0, tigr->w, tigr->h, 1.0);
+		}
+	}
+	else
+	{
+		std::cout << CONSOLE_ERR("FEHImage::DrawSubpixel called without a file open.") << std::endl;
+	}
+}
+
+// Pack the alpha channel into rows of 64-bit words and find the visible bounds
+void FEHImage::BuildMask()
+{
+	int w = tigr->w, h = tigr->h;
+	maskStride = (w + 63) / 64;
+	mask = new uint64_t[maskStride * h]();
+
+	maskLeft = w;
+	maskTop = h;
+	maskRight = 0;
+	maskBottom = 0;
+
+	for (int y = 0; y < h; y++)
+	{
+		TPixel *src = &tigr->pix[y * w];
+		uint64_t *row = &mask[y * maskStride];
+		for (int x = 0; x < w; x++)
+		{
+			if (src[x].a >= 128)
+			{
+				row[x >> 6] |= (uint64_t)1 << (x & 63);
+				if (x < maskLeft) maskLeft = x;
+				if (x >= maskRight) maskRight = x + 1;
+				if (y < maskTop) maskTop = y;
+				maskBottom = y + 1;
+			}
+		}
+	}
+
+	// Fully transparent image, leave an empty box
+	if (maskRight == 0)
+	{
+		maskLeft = maskTop = 0;
+	}
+}
+
+// Read 64 mask bits starting at column start of a row; columns past the end of the row read as 0
+static inline uint64_t maskBits(const uint64_t *row, int stride, int start)
+{
+	int word = start >> 6, shift = start & 63;
+	uint64_t lo = word < stride ? row[word] : 0;
+	if (shift == 0)
+	{
+		return lo;
+	}
+	uint64_t hi = word + 1 < stride ? row[word + 1] : 0;
+	return (lo >> shift) | (hi << (64 - shift));
+}
+
+bool FEHImage::Overlaps(int x, int y, const FEHImage &other, int otherX, int otherY) const
+{
+	if (!mask || !other.mask)
+	{
+		return false;
+	}
+
+	// Intersect the visible bounds of both images in screen coordinates
+	int left = std::max(x + maskLeft, otherX + other.maskLeft);
+	int right = std::min(x + maskRight, otherX + other.maskRight);
+	int top = std::max(y + maskTop, otherY + other.maskTop);
+	int bottom = std::min(y + maskBottom, otherY + other.maskBottom);
+	if (left >= right || top >= bottom)
+	{
+		return false;
+	}
+
+	// AND the masks over the overlap, 64 columns at a time
+	int width = right - left;
+	int startA = left - x, startB = left - otherX;
+	for (int row = top; row < bottom; row++)
+	{
+		const uint64_t *rowA = &mask[(row - y) * maskStride];
+		const uint64_t *rowB = &other.mask[(row - otherY) * other.maskStride];
+		for (int col = 0; col < width; col += 64)
+		{
+			uint64_t bits = maskBits(rowA, maskStride, startA + col) & maskBits(rowB, other.maskStride, startB + col);
+			if (width - col < 64)
+			{
+				bits &= ((uint64_t)1 << (width - col)) - 1;
+			}
+			if (bits)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
@@ -2,6 +2,7 @@
 #include <FEHLCD.h>
 #include <fstream>
 #include <iostream>
+#include <stdint.h>
 #include <tigr.h>
 
 #ifndef FEHIMAGES_H
@@ -12,11 +13,18 @@ class FEHImage
 {
 	public:
 		/// @brief Create a blank image object
-		FEHImage() {}
+		FEHImage() : tigr(NULL), mask(NULL), refs(NULL) {}
 
 		/// @brief Create an image object from a file
 		/// @param filename The name of the file to open
-		FEHImage(const char * filename) { Open(filename); }
+		FEHImage(const char * filename) : tigr(NULL), mask(NULL), refs(NULL) { Open(filename); }
+
+		/// @brief Create another handle to an already opened image
+		/// @note The decoded image is shared, not copied; it is freed when the last handle goes away
+		FEHImage(const FEHImage &other);
+		FEHImage &operator=(const FEHImage &other);
+
+		~FEHImage() { Release(); }
 
 		/// @brief Open an image file
 		/// @param filename The name of the file to open. Must end in .png or (legacy) .pic 
@@ -27,6 +35,28 @@ class FEHImage
 		/// @param y Y coordinate of upper left corner of image
 		void Draw(int x, int y);
 
+		/// @brief Draw the image at a fractional location
+		/// @param x X coordinate of upper left corner of image, filtered between pixels for smooth horizontal motion
+		/// @param y Y coordinate of upper left corner of image, rounded down to a whole pixel
+		/// @note Whole-number coordinates draw exactly like Draw()
+		void DrawSubpixel(float x, float y);
+
+		/// @brief Width of the image in pixels, or 0 if no image is open
+		int Width() const { return tigr ? tigr->w : 0; }
+
+		/// @brief Height of the image in pixels, or 0 if no image is open
+		int Height() const { return tigr ? tigr->h : 0; }
+
+		/// @brief Check if the visible pixels of two images overlap
+		/// @param x X coordinate of upper left corner of this image
+		/// @param y Y coordinate of upper left corner of this image
+		/// @param other Image to test against
+		/// @param otherX X coordinate of upper left corner of the other image
+		/// @param otherY Y coordinate of upper left corner of the other image
+		/// @return True if at least one pixel is visible in both images
+		/// @note Uses the collision masks built when each image was opened; a pixel counts as visible if its alpha is at least 128
+		bool Overlaps(int x, int y, const FEHImage &other, int otherX, int otherY) const;
+
 		/// @brief (LEGACY) Close the image file
 		/// @deprecated This function is no longer necessary, do not use
 		void Close() {}
@@ -35,7 +65,23 @@ class FEHImage
 		/// @brief Open a .pic file
 		void OpenPic(const char *);
 
+		/// @brief Drop this handle's reference, freeing the image if it was the last one
+		void Release();
+
+		/// @brief Build the collision mask and visible bounds from the image's alpha channel
+		void BuildMask();
+
 		Tigr *tigr;
+
+		// 1-bit collision mask, one bit per pixel, packed into maskStride 64-bit words per row
+		uint64_t *mask;
+		int maskStride;
+
+		// Bounds of the visible pixels (right and bottom are exclusive)
+		int maskLeft, maskTop, maskRight, maskBottom;
+
+		// Number of handles sharing tigr and mask; handles are only copied and dropped on the game's thread
+		int *refs;
 };
 
 #endif
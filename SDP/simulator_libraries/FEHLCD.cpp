@@ -2,13 +2,19 @@
 #include "FEHSD.h"
 #include "FEHUtility.h"
 #include "FEHRandom.h"
+#include "FEHLatency.h"
+#include "FEHDrawList.h"
+#include "FEHRecorder.h"
+#include "FEHScript.h"
+#include "FEHProfile.h"
+#include "FEHAlloc.h"
 #include <iostream>
-
-#define WINDOW_WIDTH LCD_WIDTH // TODO: Consider changing the actual window width and height to have a border around the "screen"
-#define WINDOW_HEIGHT LCD_HEIGHT
-
-#define CHAR_HEIGHT 17
-#define CHAR_WIDTH 12
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 unsigned char FEHLCD::fontData[] = {
     0x00, 0x00, 0x00, 0x00, 0x00, // (space)
@@ -120,9 +126,6 @@ FEHLCD::FEHLCD()
 {
     Initialize();
 
-    _maxlines = 14;
-    _maxcols = 26;
-
     _currentline = 0;
     _currentchar = 0;
 }
@@ -139,12 +142,99 @@ void FEHLCD::Initialize()
 
 void FEHLCD::_Initialize()
 {
-    _width = LCD_WIDTH;
-    _height = LCD_HEIGHT;
     _forecolor = WHITE;
     _backcolor = BLACK;
 
-    screen = tigrWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Proteus Simulator", TIGR_FIXED & TIGR_RETINA);
+    int width = LCD_WIDTH, height = LCD_HEIGHT;
+    if (const char *resolution = getenv("FEH_RESOLUTION"))
+    {
+        if (sscanf(resolution, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+        {
+            std::cout << CONSOLE_WARN("Unknown FEH_RESOLUTION [" << CONSOLE_BLUE(resolution) << "], using " << LCD_WIDTH << "x" << LCD_HEIGHT << "\n");
+            width = LCD_WIDTH;
+            height = LCD_HEIGHT;
+        }
+    }
+    // Decided before the window opens, since headless means there is none
+    _headless = getenv("FEH_HEADLESS") != NULL;
+    _script = NULL;
+    _quit = false;
+    _shotFrame = 0;
+    _shotTime = tigrClock();
+    OpenWindow(width, height);
+
+    _frame = 0;
+    _firstEvent = 0;
+    _numEvents = 0;
+    memset(&_input, 0, sizeof(_input));
+    _render = NULL;
+    drawList = NULL;
+    recorder = NULL;
+    latency = NULL;
+    if (getenv("FEH_TRACE_LATENCY"))
+        TraceLatency(true);
+    profile = NULL;
+    _benchFrames = 0;
+    if (getenv("FEH_PROFILE"))
+        Profile(true);
+    if (getenv("FEH_TRACK_ALLOCATIONS"))
+        TrackAllocations(true);
+
+    _presentMode = FEH_PRESENT_VSYNC;
+    _framePeriod = 0;
+    _nextFrame = 0;
+    if (const char *present = getenv("FEH_PRESENT"))
+    {
+        if (strcmp(present, "vsync") == 0)
+            SetPresentMode(FEH_PRESENT_VSYNC);
+        else if (strcmp(present, "immediate") == 0)
+            SetPresentMode(FEH_PRESENT_IMMEDIATE);
+        else if (strcmp(present, "adaptive") == 0)
+            SetPresentMode(FEH_PRESENT_ADAPTIVE);
+        else if (atoi(present) > 0)
+            SetPresentMode(FEH_PRESENT_CAPPED, atoi(present));
+        else
+            std::cout << CONSOLE_WARN("Unknown FEH_PRESENT mode [" << CONSOLE_BLUE(present) << "], using vsync\n");
+    }
+
+    // After FEH_PRESENT, which benchmarking overrides
+    if (const char *bench = getenv("FEH_BENCH"))
+    {
+        _benchFrames = atoi(bench);
+        if (_benchFrames > 0)
+        {
+            Profile(true);
+            SetPresentMode(FEH_PRESENT_IMMEDIATE);
+        }
+        else
+        {
+            std::cout << CONSOLE_WARN("FEH_BENCH should be a number of frames, not [" << CONSOLE_BLUE(bench) << "]\n");
+            _benchFrames = 0;
+        }
+    }
+
+    if (const char *threads = getenv("FEH_DRAW_THREADS"))
+        SetDrawThreads(atoi(threads));
+
+    if (getenv("FEH_RENDER_THREAD") && !SetRenderThread(true))
+        std::cout << CONSOLE_WARN("FEH_RENDER_THREAD is not supported on this platform, presenting from the main thread\n");
+
+    if (const char *record = getenv("FEH_RECORD"))
+        StartRecording(record);
+
+    if (const char *script = getenv("FEH_SCRIPT"))
+    {
+        if (!_headless)
+        {
+            std::cout << CONSOLE_WARN("FEH_SCRIPT is only played back when FEH_HEADLESS is set\n");
+        }
+        else
+        {
+            _script = new FEHScript();
+            if (!_script->Load(script))
+                exit(1);
+        }
+    }
 
     Clear();
 
@@ -154,8 +244,115 @@ void FEHLCD::_Initialize()
     // in TimeNow() and similar functions in FEHUtility.
     ResetTime();
 
-    // Also seed the random
-    Random.Seed();
+    // Also seed the random, the same way every run when headless so runs can be compared
+    if (_headless)
+        Random.Seed(1);
+    else
+        Random.Seed();
+}
+
+void FEHLCD::OpenWindow(int width, int height)
+{
+    _width = width;
+    _height = height;
+    _maxlines = _height / CHAR_HEIGHT;
+    _maxcols = _width / CHAR_WIDTH;
+
+    if (_headless)
+        window = tigrBitmap(width, height);
+    else
+        window = tigrWindow(width, height, "Proteus Simulator", TIGR_FIXED & TIGR_RETINA);
+    screen = window;
+}
+
+bool FEHLCD::SetResolution(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        std::cout << CONSOLE_ERR("(SetResolution) Invalid resolution: " << width << "x" << height) << std::endl;
+        return false;
+    }
+    if (width == _width && height == _height)
+        return true;
+
+    // Every frame of a recording has the same size
+    if (recorder)
+    {
+        std::cout << CONSOLE_WARN("(SetResolution) Stopping the recording, since its frames can't change size\n");
+        StopRecording();
+    }
+
+    // The window is opened again at the new size, with the same present settings
+    Flush();
+    bool threaded = _render != NULL;
+    SetRenderThread(false);
+
+    tigrFree(window);
+    OpenWindow(width, height);
+    SetPresentMode(_presentMode, _framePeriod > 0 ? (int)(1.0 / _framePeriod + 0.5) : 0);
+
+    if (threaded)
+        SetRenderThread(true);
+
+    _currentline = 0;
+    _currentchar = 0;
+    _Clear();
+    return true;
+}
+
+bool FEHLCD::Screenshot(const char *path, int scale)
+{
+    if (scale < 1)
+    {
+        std::cout << CONSOLE_ERR("(Screenshot) Invalid scale: " << scale) << std::endl;
+        return false;
+    }
+
+    Flush();
+    Tigr *image = screen;
+    if (scale > 1)
+    {
+        image = tigrBitmap(_width * scale, _height * scale);
+        tigrScaleNearest(image, screen, scale);
+    }
+
+    bool saved = tigrSaveImage(path, image) != 0;
+    if (!saved)
+    {
+        std::cout << CONSOLE_ERR("(Screenshot) Could not write " << path) << std::endl;
+    }
+
+    if (image != screen)
+    {
+        tigrFree(image);
+    }
+    return saved;
+}
+
+bool FEHLCD::StartRecording(const char *path, int buffers)
+{
+    StopRecording();
+
+    int fps = _presentMode == FEH_PRESENT_CAPPED && _framePeriod > 0 ? (int)(1.0 / _framePeriod + 0.5) : 60;
+    recorder = new FEHRecorder(path, _width, _height, fps, buffers);
+    if (!recorder->IsOpen())
+    {
+        delete recorder;
+        recorder = NULL;
+        return false;
+    }
+    return true;
+}
+
+void FEHLCD::StopRecording()
+{
+    if (!recorder)
+        return;
+
+    recorder->Stop();
+    recorder->Print();
+    delete recorder;
+    recorder = NULL;
 }
 
 bool FEHLCD::Touch(float *x_pos, float *y_pos, bool update_screen)
@@ -173,10 +370,581 @@ bool FEHLCD::Touch(int *x_pos, int *y_pos, bool update_screen)
     if (update_screen)
         Update();
 
-    int mouseButton;
-    tigrMouse(screen, x_pos, y_pos, &mouseButton);
+    *x_pos = _input.mouseX;
+    *y_pos = _input.mouseY;
+
+    return (_input.mouseButtons & 0x01) == 1;
+}
+
+void FEHLCD::ReadInput(Tigr *window, InputState *state)
+{
+    for (int key = 0; key < 256; key++)
+    {
+        state->held[key] = tigrKeyHeld(window, key) != 0;
+        state->pressed[key] = state->pressed[key] || tigrKeyDown(window, key);
+        state->released[key] = state->released[key] || tigrKeyUp(window, key);
+    }
+    tigrMouse(window, &state->mouseX, &state->mouseY, &state->mouseButtons);
+
+    int c = tigrReadChar(window);
+    if (c)
+        state->lastChar = c;
+}
+
+void FEHLCD::ReadEvents()
+{
+    TigrEvent e;
+    while (tigrPollEvent(window, &e))
+        QueueEvent(e);
+}
+
+void FEHLCD::ApplyEvent(const TigrEvent &e, InputState *state)
+{
+    switch (e.type)
+    {
+    case TIGR_EVENT_MOUSE_DOWN:
+    case TIGR_EVENT_MOUSE_UP:
+    case TIGR_EVENT_MOUSE_MOVE:
+        state->mouseX = e.x;
+        state->mouseY = e.y;
+        state->mouseButtons = e.buttons;
+        break;
+    case TIGR_EVENT_KEY_DOWN:
+        state->held[e.key] = true;
+        state->pressed[e.key] = true;
+        break;
+    case TIGR_EVENT_KEY_UP:
+        state->held[e.key] = false;
+        state->released[e.key] = true;
+        break;
+    }
+}
+
+void FEHLCD::RunScript()
+{
+    FEHScript::Command c;
+    while (_script->Next(_frame, &c))
+    {
+        TigrEvent e;
+        memset(&e, 0, sizeof(e));
+        e.x = _input.mouseX;
+        e.y = _input.mouseY;
+        e.buttons = _input.mouseButtons;
+        e.time = tigrClock();
+
+        // Mouse commands move there first, as a real mouse would
+        if (c.type <= FEHScript::CLICK && (c.x != e.x || c.y != e.y))
+        {
+            e.type = TIGR_EVENT_MOUSE_MOVE;
+            e.x = c.x;
+            e.y = c.y;
+            ApplyEvent(e, &_input);
+            QueueEvent(e);
+        }
+
+        switch (c.type)
+        {
+        case FEHScript::MOVE:
+            break;
+        case FEHScript::DOWN:
+        case FEHScript::UP:
+        case FEHScript::CLICK:
+            e.button = 0x01;
+            if (c.type != FEHScript::UP)
+            {
+                e.type = TIGR_EVENT_MOUSE_DOWN;
+                e.buttons |= 0x01;
+                ApplyEvent(e, &_input);
+                QueueEvent(e);
+            }
+            if (c.type != FEHScript::DOWN)
+            {
+                e.type = TIGR_EVENT_MOUSE_UP;
+                e.buttons &= ~0x01;
+                ApplyEvent(e, &_input);
+                QueueEvent(e);
+            }
+            break;
+        case FEHScript::KEY_DOWN:
+        case FEHScript::KEY_UP:
+            e.type = c.type == FEHScript::KEY_DOWN ? TIGR_EVENT_KEY_DOWN : TIGR_EVENT_KEY_UP;
+            e.key = c.key;
+            ApplyEvent(e, &_input);
+            QueueEvent(e);
+            break;
+        case FEHScript::SHOT:
+        {
+            // Time per frame since the last screenshot, which says what the screens in between cost
+            double now = tigrClock();
+            int frames = _frame - _shotFrame;
+            printf("%-48s frame %6d %10.3f ms/frame\n", c.path.c_str(), _frame, frames > 0 ? (now - _shotTime) * 1000.0 / frames : 0.0);
+            Screenshot(c.path.c_str());
+            _shotFrame = _frame;
+            _shotTime = tigrClock();
+            break;
+        }
+        case FEHScript::QUIT:
+            _quit = true;
+            break;
+        case FEHScript::REPEAT:
+            // Never returned: Next() consumes repeats itself by rewinding the script
+            break;
+        }
+    }
+}
+
+void FEHLCD::QueueEvent(const TigrEvent &e)
+{
+    FEHEvent event;
+    switch (e.type)
+    {
+    case TIGR_EVENT_MOUSE_DOWN:
+    case TIGR_EVENT_MOUSE_UP:
+        // Only the left button touches the screen
+        if (e.button != 0x01)
+            return;
+        event.type = e.type == TIGR_EVENT_MOUSE_DOWN ? FEH_EVENT_TOUCH_DOWN : FEH_EVENT_TOUCH_UP;
+        break;
+    case TIGR_EVENT_MOUSE_MOVE:
+        event.type = FEH_EVENT_TOUCH_MOVE;
+        break;
+    case TIGR_EVENT_KEY_DOWN:
+        event.type = FEH_EVENT_KEY_DOWN;
+        break;
+    case TIGR_EVENT_KEY_UP:
+        event.type = FEH_EVENT_KEY_UP;
+        break;
+    default:
+        return;
+    }
+
+    event.x = e.x;
+    event.y = e.y;
+    event.touching = (e.buttons & 0x01) == 1;
+    event.key = e.key;
+    event.time = e.time;
+
+    if (latency && event.type != FEH_EVENT_TOUCH_MOVE)
+        latency->Input(event.time);
 
-    return (mouseButton & 0x01) == 1;
+    // When nobody reads the queue, keep the newest events
+    if (_numEvents == FEH_MAX_EVENTS)
+    {
+        _firstEvent = (_firstEvent + 1) % FEH_MAX_EVENTS;
+        _numEvents--;
+    }
+    _events[(_firstEvent + _numEvents) % FEH_MAX_EVENTS] = event;
+    _numEvents++;
+}
+
+bool FEHLCD::PollEvent(FEHEvent *event)
+{
+    if (_numEvents == 0)
+        return false;
+
+    *event = _events[_firstEvent];
+    _firstEvent = (_firstEvent + 1) % FEH_MAX_EVENTS;
+    _numEvents--;
+    return true;
+}
+
+void FEHLCD::ClearEvents()
+{
+    _firstEvent = 0;
+    _numEvents = 0;
+}
+
+bool FEHLCD::SetPresentMode(FEHPresentMode mode, int maxFPS)
+{
+    int interval = 1;
+    if (mode == FEH_PRESENT_IMMEDIATE || mode == FEH_PRESENT_CAPPED)
+        interval = 0;
+    else if (mode == FEH_PRESENT_ADAPTIVE)
+        interval = -1;
+
+    bool supported = SetSwapInterval(interval);
+    if (!supported && mode == FEH_PRESENT_ADAPTIVE)
+    {
+        SetSwapInterval(1);
+        mode = FEH_PRESENT_VSYNC;
+    }
+
+    _presentMode = mode;
+    _framePeriod = maxFPS > 0 ? 1.0 / maxFPS : 0;
+    _nextFrame = tigrClock();
+    return supported;
+}
+
+// Sleep until a tigrClock() time, spinning for the last stretch since sleeps overshoot
+static void WaitUntil(double time)
+{
+    double left;
+    while ((left = time - tigrClock()) > 0.002)
+        std::this_thread::sleep_for(std::chrono::duration<double>(left - 0.002));
+    while (tigrClock() < time)
+    {
+    }
+}
+
+// Presentation on a thread of its own, see FEHLCD::SetRenderThread().
+// Frames go to it through three buffers: the game fills frames[back], the render thread shows frames[front],
+// and middle holds the newest finished frame, marked FRESH until the render thread takes it. Either side swaps
+// its buffer with the middle one, so neither waits for the other to finish with a frame; when the present mode
+// follows the display, the game still waits for its previous frame to be taken, see FEHLCD::HandOff().
+// Whichever side has nothing to do sleeps on changed, which the other signals after each swap.
+// Input comes back under the lock, since Update() only takes it once per frame.
+struct FEHLCD::RenderThread
+{
+    static const int FRESH = 4;
+    static const int NO_REQUEST = -2;
+
+    FEHLCD *lcd;
+    Tigr *window;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<bool> closed;
+
+    // Wait for each frame to reach the screen, for latency tracing
+    std::atomic<bool> waitPresent;
+
+    // Swap interval for the render thread to set, since the OpenGL context belongs to it
+    std::atomic<int> swapRequest;
+    std::atomic<bool> swapSupported;
+
+    TPixel *frames[3];
+    int frameNumber[3];
+    int back, front;
+    std::atomic<int> middle;
+
+    // Swaps with the middle buffer happen under handLock, so a side waiting on changed can't miss one
+    std::mutex handLock;
+    std::condition_variable changed;
+
+    // Everything below is guarded by lock, along with lcd->latency
+    std::mutex lock;
+    InputState input;
+    TigrEvent events[FEH_MAX_EVENTS];
+    int numEvents;
+
+    RenderThread(FEHLCD *lcd, Tigr *window);
+    ~RenderThread();
+
+    void Run();
+
+    /// @brief Move the input collected since the last call into lcd
+    void GiveInput();
+};
+
+FEHLCD::RenderThread::RenderThread(FEHLCD *lcd, Tigr *window)
+    : lcd(lcd), window(window), running(true), closed(false), swapRequest(NO_REQUEST), swapSupported(false)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        frames[i] = new TPixel[window->w * window->h];
+        frameNumber[i] = -1;
+    }
+    back = 0;
+    front = 1;
+    middle = 2;
+
+    waitPresent = lcd->latency != NULL;
+    input = lcd->_input;
+    memset(input.pressed, 0, sizeof(input.pressed));
+    memset(input.released, 0, sizeof(input.released));
+    input.lastChar = 0;
+    numEvents = 0;
+}
+
+FEHLCD::RenderThread::~RenderThread()
+{
+    for (int i = 0; i < 3; i++)
+        delete[] frames[i];
+}
+
+void FEHLCD::RenderThread::Run()
+{
+    while (running)
+    {
+        int request = swapRequest;
+        if (request != NO_REQUEST)
+        {
+            swapSupported = tigrSetSwapInterval(window, request) != 0;
+            swapRequest = NO_REQUEST;
+        }
+
+        // Until the game finishes another frame there is nothing to show, and its input can wait too
+        {
+            std::unique_lock<std::mutex> hand(handLock);
+            changed.wait(hand, [this]() { return (middle & FRESH) || !running || swapRequest != NO_REQUEST; });
+            if (!(middle & FRESH))
+                continue;
+            front = middle.exchange(front) & ~FRESH;
+        }
+        // The game may be waiting for this frame to be taken
+        changed.notify_all();
+        memcpy(window->pix, frames[front], window->w * window->h * sizeof(TPixel));
+
+        tigrUpdate(window);
+        if (waitPresent)
+            tigrWaitPresent(window);
+        double presented = tigrClock();
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (lcd->latency)
+            lcd->latency->Present(frameNumber[front], presented);
+
+        ReadInput(window, &input);
+        TigrEvent e;
+        while (tigrPollEvent(window, &e))
+        {
+            // Like FEHLCD::QueueEvent(), keep the newest events when nobody takes them
+            if (numEvents == FEH_MAX_EVENTS)
+            {
+                memmove(events, events + 1, (FEH_MAX_EVENTS - 1) * sizeof(TigrEvent));
+                numEvents--;
+            }
+            events[numEvents++] = e;
+        }
+
+        if (tigrClosed(window))
+        {
+            std::lock_guard<std::mutex> hand(handLock);
+            closed = true;
+            changed.notify_all();
+        }
+    }
+
+    // Give the OpenGL context back for whichever thread presents next
+    tigrEndOpenGL(window);
+}
+
+void FEHLCD::RenderThread::GiveInput()
+{
+    int unread = lcd->_input.lastChar;
+    lcd->_input = input;
+    if (!lcd->_input.lastChar)
+        lcd->_input.lastChar = unread;
+
+    memset(input.pressed, 0, sizeof(input.pressed));
+    memset(input.released, 0, sizeof(input.released));
+    input.lastChar = 0;
+
+    for (int i = 0; i < numEvents; i++)
+        lcd->QueueEvent(events[i]);
+    numEvents = 0;
+}
+
+bool FEHLCD::SetRenderThread(bool on)
+{
+    if (on == (_render != NULL))
+        return true;
+
+    // Nothing to present
+    if (_headless)
+        return !on;
+
+#if __linux__ && !__ANDROID__
+    // Recorded calls belong in the bitmap being replaced
+    Flush();
+
+    if (on)
+    {
+        // The game keeps drawing into a bitmap of its own, which Update() copies for the render thread
+        screen = tigrBitmap(window->w, window->h);
+        memcpy(screen->pix, window->pix, window->w * window->h * sizeof(TPixel));
+
+        _render = new RenderThread(this, window);
+        tigrEndOpenGL(window);
+        _render->thread = std::thread(&RenderThread::Run, _render);
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> hand(_render->handLock);
+            _render->running = false;
+        }
+        _render->changed.notify_all();
+        _render->thread.join();
+        _render->GiveInput();
+
+        memcpy(window->pix, screen->pix, window->w * window->h * sizeof(TPixel));
+        tigrFree(screen);
+        screen = window;
+
+        delete _render;
+        _render = NULL;
+    }
+    return true;
+#else
+    // Windows and macOS only deliver a window's input to the thread that created it
+    return !on;
+#endif
+}
+
+void FEHLCD::HandOff()
+{
+    RenderThread *r = _render;
+
+    memcpy(r->frames[r->back], screen->pix, screen->w * screen->h * sizeof(TPixel));
+    r->frameNumber[r->back] = _frame;
+
+    // The render thread takes a frame per refresh, so waiting for it to take the last one holds the game to the
+    // display's rate rather than making frames that are replaced before they're shown. Immediate mode doesn't
+    // follow the display, and capped mode already sleeps to its own schedule
+    {
+        std::unique_lock<std::mutex> hand(r->handLock);
+        if (_presentMode == FEH_PRESENT_VSYNC || _presentMode == FEH_PRESENT_ADAPTIVE)
+            r->changed.wait(hand, [r]() { return !(r->middle & RenderThread::FRESH) || r->closed; });
+        r->back = r->middle.exchange(r->back | RenderThread::FRESH) & ~RenderThread::FRESH;
+    }
+    r->changed.notify_all();
+
+    std::lock_guard<std::mutex> guard(r->lock);
+    r->GiveInput();
+}
+
+bool FEHLCD::SetSwapInterval(int interval)
+{
+    if (_headless)
+        return true;
+    if (!_render)
+        return tigrSetSwapInterval(window, interval) != 0;
+
+    {
+        std::lock_guard<std::mutex> hand(_render->handLock);
+        _render->swapRequest = interval;
+    }
+    _render->changed.notify_all();
+    while (_render->swapRequest != RenderThread::NO_REQUEST)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return _render->swapSupported;
+}
+
+void FEHLCD::SetDrawThreads(int threads)
+{
+    Flush();
+
+    if (threads <= 0)
+    {
+        delete drawList;
+        drawList = NULL;
+    }
+    else if (drawList)
+        drawList->SetThreads(threads);
+    else
+        drawList = new FEHDrawList(threads, &frameArena);
+}
+
+int FEHLCD::DrawThreads()
+{
+    return drawList ? drawList->Threads() : 0;
+}
+
+void FEHLCD::Flush()
+{
+    if (drawList)
+        drawList->Execute(screen);
+}
+
+void FEHLCD::TraceLatency(bool on)
+{
+    // The render thread completes samples, see RenderThread::Run()
+    std::unique_lock<std::mutex> guard;
+    if (_render)
+    {
+        guard = std::unique_lock<std::mutex>(_render->lock);
+        _render->waitPresent = on;
+    }
+
+    if (on && !latency)
+    {
+        latency = new FEHLatency();
+    }
+    else if (!on && latency)
+    {
+        delete latency;
+        latency = NULL;
+    }
+}
+
+void FEHLCD::Reacted()
+{
+    std::unique_lock<std::mutex> guard;
+    if (_render)
+        guard = std::unique_lock<std::mutex>(_render->lock);
+
+    if (latency)
+        latency->React(_frame, tigrClock());
+}
+
+void FEHLCD::PrintLatency()
+{
+    if (latency)
+        latency->Print();
+}
+
+void FEHLCD::Profile(bool on)
+{
+    if (on && !profile)
+    {
+        profile = new FEHProfile();
+    }
+    else if (!on && profile)
+    {
+        delete profile;
+        profile = NULL;
+    }
+}
+
+void FEHLCD::Phase(const char *name)
+{
+    if (profile)
+        profile->Phase(name, tigrClock());
+}
+
+void FEHLCD::PrintProfile()
+{
+    if (profile)
+        profile->Print(tigrClock());
+}
+
+void FEHLCD::TrackAllocations(bool on)
+{
+    if (on && !FEHAlloc::Available())
+    {
+        std::cout << CONSOLE_WARN("(TrackAllocations) Allocations are only seen in builds made with make TRACK_ALLOC=1\n");
+        return;
+    }
+    FEHAlloc::Frame(_frame);
+    FEHAlloc::Track(on);
+}
+
+void FEHLCD::PrintAllocations()
+{
+    if (FEHAlloc::Tracking())
+        FEHAlloc::Print();
+}
+
+bool FEHLCD::KeyPressed(int key)
+{
+    return key > 0 && key < 256 && _input.pressed[key];
+}
+
+bool FEHLCD::KeyHeld(int key)
+{
+    return key > 0 && key < 256 && _input.held[key];
+}
+
+bool FEHLCD::KeyReleased(int key)
+{
+    return key > 0 && key < 256 && _input.released[key];
+}
+
+int FEHLCD::ReadChar()
+{
+    int c = _input.lastChar;
+    _input.lastChar = 0;
+    return c;
 }
 
 
@@ -195,10 +963,77 @@ void FEHLCD::Clear()
 
 void FEHLCD::Update()
 {
-    tigrUpdate(screen);
+    Phase("present");
+
+    if (_presentMode == FEH_PRESENT_CAPPED)
+    {
+        // A late frame moves the schedule back instead of letting the next ones catch up in a burst
+        double now = tigrClock();
+        _nextFrame += _framePeriod;
+        if (_nextFrame < now)
+            _nextFrame = now;
+        else
+            WaitUntil(_nextFrame);
+    }
+
+    Flush();
 
-    if (tigrClosed(screen)) {
+    if (recorder)
+        recorder->Capture(screen);
+
+    if (_render)
+    {
+        HandOff();
+    }
+    else if (!_headless)
+    {
+        tigrUpdate(window);
+
+        if (latency)
+        {
+            // Waiting for the GPU is what makes the time mean "on screen", at the cost of the overlap it normally has
+            tigrWaitPresent(window);
+            latency->Present(_frame, tigrClock());
+        }
+    }
+    _frame++;
+    FEHAlloc::Frame(_frame);
+
+    // The frame has been drawn from everything it recorded, so its scratch memory is free again
+    frameArena.Reset();
+
+    if (!_render)
+    {
+        memset(_input.pressed, 0, sizeof(_input.pressed));
+        memset(_input.released, 0, sizeof(_input.released));
+        if (_headless)
+        {
+            if (_script)
+                RunScript();
+        }
+        else
+        {
+            ReadInput(window, &_input);
+            ReadEvents();
+        }
+    }
+
+    if (profile)
+    {
+        profile->Frame();
+        Phase("other");
+    }
+
+    bool benchDone = _benchFrames > 0 && profile && profile->Frames() >= _benchFrames;
+    if (benchDone || (_render ? _render->closed.load() : _headless ? _quit : tigrClosed(window))) {
+        SetRenderThread(false);
+        PrintLatency();
+        PrintProfile();
+        PrintAllocations();
+        StopRecording();
         SD.FCloseAll();
+        // Hand back the bitmap memory tigr kept for reuse, so leak checkers only see what was really left behind
+        tigrPoolTrim();
         exit(0);
     }
 }
@@ -227,7 +1062,7 @@ void Swap(int *a, int *b)
 *   DRAWING FUNCTIONS    *
 *************************/
 
-// DrawPixel takes in Proteus coordinates up to (320, 240)
+// DrawPixel takes in coordinates up to (Width(), Height())
 void FEHLCD::DrawPixel(int x, int y)
 {
     // Force X and Y to be positive
@@ -245,7 +1080,10 @@ void FEHLCD::DrawPixel(int x, int y)
     x = x % _width;
     y = y % _height;
 
-    tigrPlot(screen, x, y, tigr_forecolor());
+    if (drawList)
+        drawList->Plot(x, y, tigr_forecolor());
+    else
+        tigrPlot(screen, x, y, tigr_forecolor());
 }
 
 void FEHLCD::DrawHorizontalLine(int y, int x1, int x2)
@@ -281,7 +1119,10 @@ void FEHLCD::DrawLine(int x1, int y1, int x2, int y2)
 
 void FEHLCD::_DrawLine(int x1, int y1, int x2, int y2)
 {
-    tigrLine(screen, x1, y1, x2, y2, tigr_forecolor());
+    if (drawList)
+        drawList->Line(x1, y1, x2, y2, tigr_forecolor());
+    else
+        tigrLine(screen, x1, y1, x2, y2, tigr_forecolor());
 }
 
 void FEHLCD::DrawRectangle(int x, int y, int width, int height)
@@ -292,7 +1133,10 @@ void FEHLCD::DrawRectangle(int x, int y, int width, int height)
     if (x + width < 0 || x + width >= _width) std::cout << CONSOLE_WARN("") << CONSOLE_BLUE("(DrawRectangle)") << " x + width is out of bounds: " << x + width << std::endl;
     if (y + height < 0 || y + height >= _height) std::cout << CONSOLE_WARN("") << CONSOLE_BLUE("(DrawRectangle)") << " y + height is out of bounds: " << y + height << std::endl;
 
-    tigrRect(screen, x, y, width, height, tigr_forecolor());
+    if (drawList)
+        drawList->Rect(x, y, width, height, tigr_forecolor());
+    else
+        tigrRect(screen, x, y, width, height, tigr_forecolor());
 }
 
 void FEHLCD::FillRectangle(int x, int y, int width, int height)
@@ -303,7 +1147,10 @@ void FEHLCD::FillRectangle(int x, int y, int width, int height)
     if (x + width < 0 || x + width >= _width) std::cout << CONSOLE_WARN("") << CONSOLE_BLUE("(FillRectangle)") << " x + width is out of bounds: " << x + width << std::endl;
     if (y + height < 0 || y + height >= _height) std::cout << CONSOLE_WARN("") << CONSOLE_BLUE("(FillRectangle)") << " y + height is out of bounds: " << y + height << std::endl;
 
-    tigrFill(screen, x, y, width, height, tigr_forecolor());
+    if (drawList)
+        drawList->Fill(x, y, width, height, tigr_forecolor());
+    else
+        tigrFill(screen, x, y, width, height, tigr_forecolor());
 }
 
 void FEHLCD::DrawCircle(int x0, int y0, int r)
@@ -396,7 +1243,7 @@ void FEHLCD::WriteAt(const char *str, int x, int y)
     }
 }
 
-void FEHLCD::WriteAt(std::string str, int x, int y)
+void FEHLCD::WriteAt(const std::string &str, int x, int y)
 {
     WriteAt(str.c_str(), x, y);
 }
@@ -554,7 +1401,7 @@ void FEHLCD::WriteLine(const char *str)
     NextLine();
 }
 
-void FEHLCD::WriteLine(std::string str)
+void FEHLCD::WriteLine(const std::string &str)
 {
     WriteLine(str.c_str());
 }
@@ -619,7 +1466,10 @@ void FEHLCD::_Clear()
 {
     // Currently takes in a 24-bit color as input
     TPixel rgbValues = tigrRGB((char)(_backcolor >> 16), (char)(_backcolor >> 8), (char)_backcolor);
-    tigrClear(screen, rgbValues);
+    if (drawList)
+        drawList->Clear(rgbValues);
+    else
+        tigrClear(screen, rgbValues);
 }
 
 
@@ -797,22 +1647,18 @@ namespace FEHIcon
     {
         if (x >= x_start && x <= x_end && y >= y_start && y <= y_end)
         {
-            LCD.Touch(&x, &y);
-            if (x >= x_start && x <= x_end && y >= y_start && y <= y_end) // check twice to avoid buggy touch screen issues
+            if (!mode) // if mode is 0, then alternate selecting and deselecting as it is pressed again and again; otherwise, the icon does not select and deselect
             {
-                if (!mode) // if mode is 0, then alternate selecting and deselecting as it is pressed again and again; otherwise, the icon does not select and deselect
+                if (!set)
+                {
+                    Select();
+                }
+                else if (set)
                 {
-                    if (!set)
-                    {
-                        Select();
-                    }
-                    else if (set)
-                    {
-                        Deselect();
-                    }
+                    Deselect();
                 }
-                return 1;
             }
+            return 1;
         }
         return 0;
     }
@@ -891,8 +1737,8 @@ namespace FEHIcon
     {
         int xs = left;
         int ys = top;
-        float total_w = (320. - left - right);
-        float total_h = (240. - top - bot);
+        float total_w = (LCD.Width() - left - right);
+        float total_h = (LCD.Height() - top - bot);
         int w = total_w / cols;
         int h = total_h / rows;
         int nx, ny, N = 0;
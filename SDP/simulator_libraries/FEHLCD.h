@@ -8,11 +8,59 @@
 #include <string>
 #include "tigr.h"
 #include "LCDColors.h"
+#include "FEHArena.h"
 
+class FEHLatency;
+class FEHDrawList;
+class FEHRecorder;
+class FEHScript;
+class FEHProfile;
 
+
+// Size of the Proteus screen, used unless FEHLCD::SetResolution() picks another
 #define LCD_WIDTH 320
 #define LCD_HEIGHT 240
 
+// Cell of one character written by WriteAt() and friends: the 5x7 font doubled, plus spacing
+#define CHAR_WIDTH 12
+#define CHAR_HEIGHT 17
+
+// Number of input events kept for PollEvent()
+#define FEH_MAX_EVENTS 64
+
+/// @brief Kinds of input events returned by FEHLCD::PollEvent()
+enum FEHEventType
+{
+    FEH_EVENT_TOUCH_DOWN,   ///< The screen started being touched (left mouse button pressed)
+    FEH_EVENT_TOUCH_MOVE,   ///< The cursor moved, touching or not
+    FEH_EVENT_TOUCH_UP,     ///< The touch ended (left mouse button released)
+    FEH_EVENT_KEY_DOWN,     ///< A key was pressed
+    FEH_EVENT_KEY_UP        ///< A key was released
+};
+
+/// @brief How FEHLCD::Update() paces frames, see FEHLCD::SetPresentMode()
+enum FEHPresentMode
+{
+    FEH_PRESENT_VSYNC,      ///< Wait for the display to refresh before showing a frame (default)
+    FEH_PRESENT_IMMEDIATE,  ///< Never wait: run as fast as possible, frames may tear
+    FEH_PRESENT_ADAPTIVE,   ///< Wait for the refresh, unless the frame is already late; late frames may tear
+    FEH_PRESENT_CAPPED      ///< Don't wait for the display, sleep to hold a set frame rate instead
+};
+
+/// @brief One input event, see FEHLCD::PollEvent()
+struct FEHEvent
+{
+    FEHEventType type;
+    /// @brief Cursor position on the screen when the event happened
+    int x, y;
+    /// @brief Whether the screen was being touched after the event
+    bool touching;
+    /// @brief Key code for key events: 'A'-'Z', '0'-'9', or a TKey from tigr.h such as TK_SPACE
+    int key;
+    /// @brief When the event happened, in seconds. Only compare it with other events' times
+    double time;
+};
+
 
 class FEHLCD
 {
@@ -20,9 +68,10 @@ class FEHLCD
 // Make the FEHImage class a friend so it can access the Tigr *screen
 // Do not let the user access the Tigr *screen directly
     friend class FEHImage;
-    // friend class FEHKeyboard;
 protected:
+    // Drawn into by everything; the window itself unless there is a render thread
     Tigr *screen;
+    Tigr *window;
 
 public:
 
@@ -32,7 +81,7 @@ public:
     FEHLCD();
 
     /// @private
-    ~FEHLCD() {}
+    ~FEHLCD() { StopRecording(); }
 
     /// @name Touch Functions
     ///@{
@@ -44,6 +93,164 @@ public:
     /// @note Pointer values are set regardless of whether or not a click was detected
     bool Touch(int *x_pos, int *y_pos, bool update_screen = true);
     bool Touch(float *x_pos, float *y_pos, bool update_screen = true);
+
+    /// @brief Take the oldest input event that happened before the last Update() call
+    /// @param event Filled in with the event if there is one
+    /// @return true if an event was read, false once there are none left
+    /// @note Unlike Touch(), no input is lost between frames: a touch that starts and ends
+    /// before the next Update() still shows up as a TOUCH_DOWN followed by a TOUCH_UP.
+    /// Only the last FEH_MAX_EVENTS events are kept
+    bool PollEvent(FEHEvent *event);
+
+    /// @brief Throw away every queued event, e.g. ones nobody read while another screen was shown
+    void ClearEvents();
+    ///@}
+
+    /// @name Keyboard Functions
+    ///@{
+    /// @brief Check the keyboard as of the last Update() call
+    /// @param key 'A'-'Z', '0'-'9', or a TKey from tigr.h such as TK_SPACE or TK_UP
+    /// @return KeyPressed: true on the one frame a key went down. KeyHeld: true on every frame it is down.
+    /// KeyReleased: true on the one frame it came back up
+    /// @note A key tapped between two Update() calls is still pressed for one frame and released on the next
+    bool KeyPressed(int key);
+    bool KeyHeld(int key);
+    bool KeyReleased(int key);
+    ///@}
+
+    /// @brief Take the last character typed before the last Update() call
+    /// @return Unicode value of the character, or 0 if none was typed since the last call
+    int ReadChar();
+
+    /// @name Presenting
+    ///@{
+    /// @brief Choose how Update() paces frames
+    /// @param mode See FEHPresentMode. The FEH_PRESENT environment variable picks one at startup:
+    /// "vsync", "immediate", "adaptive", or a number of frames per second for FEH_PRESENT_CAPPED
+    /// @param maxFPS Frame rate held by FEH_PRESENT_CAPPED
+    /// @return false if the graphics driver doesn't support the mode. Unsupported adaptive falls back to vsync;
+    /// the others keep the display's pace, with FEH_PRESENT_CAPPED still limiting to maxFPS
+    bool SetPresentMode(FEHPresentMode mode, int maxFPS = 60);
+
+    /// @brief Current present mode
+    FEHPresentMode PresentMode() { return _presentMode; }
+
+    /// @brief Present frames from a thread of their own, so Update() hands the frame over and returns without waiting for the display
+    /// @param on Turn the render thread on or off; setting the FEH_RENDER_THREAD environment variable turns it on at startup
+    /// @return false if presenting from another thread isn't supported on this platform (only Linux is), in which case nothing changes
+    /// @note A frame shows up on screen while the game works on the next one. Input is still taken once per Update(),
+    /// from everything the render thread saw since the last one
+    /// @note With FEH_PRESENT_VSYNC and FEH_PRESENT_ADAPTIVE, Update() still waits while the render thread hasn't taken
+    /// the previous frame, so the game keeps the display's pace with at most one frame waiting to be shown
+    bool SetRenderThread(bool on);
+
+    /// @brief Record draw calls and run them at Update(), split over threads that each draw their own horizontal band of the screen
+    /// @param threads 0 draws every call immediately (the default); 1 or more records them and uses that many threads.
+    /// The FEH_DRAW_THREADS environment variable sets it at startup
+    /// @note The screen looks the same either way. Only pays off when frames blend a lot of large images
+    void SetDrawThreads(int threads);
+
+    /// @brief Number of threads drawing the screen, or 0 when drawing immediately
+    int DrawThreads();
+    ///@}
+
+    /// @name Latency Tracing
+    ///@{
+    /// @brief Measure how long input takes to show up on screen
+    /// @param on Turn tracing on or off; setting the FEH_TRACE_LATENCY environment variable turns it on at startup
+    /// @note While tracing, Update() waits for every frame to reach the screen, which lowers the frame rate
+    void TraceLatency(bool on);
+
+    /// @brief Tell latency tracing that the game just changed its state because of input, e.g. a button was pressed or a jump started
+    /// @note Completes a sample from the oldest press or release not reacted to yet, to the end of the next Update()
+    void Reacted();
+
+    /// @brief Print the latency distribution measured so far; also printed when the window is closed
+    void PrintLatency();
+    ///@}
+
+    /// @name Profiling
+    ///@{
+    /// @brief Measure where the time of each frame goes
+    /// @param on Turn profiling on or off; setting the FEH_PROFILE environment variable turns it on at startup
+    /// @note Update() counts as the "present" phase, and the time after it until the game starts another phase as "other".
+    /// Setting FEH_BENCH to a number of frames profiles that many without waiting on the display, then prints the
+    /// profile and ends the program; with FEH_HEADLESS and FEH_SCRIPT it benchmarks the whole game
+    void Profile(bool on);
+
+    /// @brief Tell profiling that the game has started a phase of its frame, e.g. "simulate" or "draw"
+    /// @param name Name shown in the profile; the game's phases are its own to name
+    void Phase(const char *name);
+
+    /// @brief Print the profile measured so far; also printed when the window is closed
+    void PrintProfile();
+
+    /// @brief Note the frame and call site of every heap allocation, to find what the game allocates frame after frame
+    /// @param on Turn tracking on or off; setting the FEH_TRACK_ALLOCATIONS environment variable turns it on at startup
+    /// @note Needs a build made with make TRACK_ALLOC=1. Slows every allocation down. Only C++ new is seen outside
+    /// Linux, see FEHAlloc
+    void TrackAllocations(bool on);
+
+    /// @brief Print allocations per frame and the call sites that made the most; also printed when the window is closed
+    void PrintAllocations();
+    ///@}
+
+    /// @name Resolution
+    ///@{
+    /// @brief Change the size of the screen in pixels, which reopens the window and clears it
+    /// @param width Width of the screen; LCD_WIDTH (320) by default
+    /// @param height Height of the screen; LCD_HEIGHT (240) by default
+    /// @return false if the size is not positive, in which case nothing changes
+    /// @note The FEH_RESOLUTION environment variable sets it at startup, e.g. "1280x720"
+    bool SetResolution(int width, int height);
+
+    /// @brief Current width of the screen in pixels
+    int Width() { return _width; }
+
+    /// @brief Current height of the screen in pixels
+    int Height() { return _height; }
+    ///@}
+
+    /// @name Recording
+    ///@{
+    /// @brief Record every frame Update() shows to disk, written by a background thread so the game keeps its pace
+    /// @param path A file ending in ".y4m" for one video, or a name for numbered PNGs such as "rec/frame%05d.png"
+    /// @param buffers Frames that can wait to be written; when all of them are waiting, frames are dropped rather than slowing the game
+    /// @return false if the output could not be opened
+    /// @note The FEH_RECORD environment variable starts recording at startup, e.g. "session.y4m".
+    /// Recording stops when the window is closed or the resolution changes
+    bool StartRecording(const char *path, int buffers = 8);
+
+    /// @brief Stop recording once the waiting frames are written, and print how many were recorded and dropped
+    void StopRecording();
+    ///@}
+
+    /// @name Frame Memory
+    ///@{
+    /// @brief Scratch memory for the current frame, all of it taken back by the next Update()
+    /// @note Anything that is only needed until the frame is shown, such as a list of what collided, can live here
+    /// instead of the heap; containers take it through FEHArenaAllocator. Only for the thread that calls Update().
+    /// The draw calls recorded with SetDrawThreads() on are kept here
+    FEHArena &FrameArena() { return frameArena; }
+    ///@}
+
+    /// @name Headless
+    ///@{
+    /// @brief Whether the screen is only a bitmap in memory, with no window
+    /// @note Setting the FEH_HEADLESS environment variable runs headless, for tests and benchmarks. Input then comes from
+    /// the script named by FEH_SCRIPT (see FEHScript), random numbers are the same every run, and frames are not held to
+    /// the display's pace. Without a script, nothing ends the program but the program itself
+    bool IsHeadless() { return _headless; }
+    ///@}
+
+    /// @name Screenshots
+    ///@{
+    /// @brief Save what has been drawn so far as a PNG, including anything drawn since the last Update()
+    /// @param path File to write, e.g. "frame.png"
+    /// @param scale Whole number to enlarge the picture by, repeating each pixel; 1 by default
+    /// @return false if scale is less than 1 or the file could not be written
+    /// @note Uses tigr's fast PNG writer, which takes a couple of milliseconds at 320x240, so frames can be captured while the game runs
+    bool Screenshot(const char *path, int scale = 1);
     ///@}
 
     /// @private
@@ -90,7 +297,7 @@ public:
     /// @param y The y coordinate to start writing at
     /// @see WriteRC() for writing at a specific row and column of the text grid
     void WriteAt(const char *val, int x, int y);
-    void WriteAt(std::string val, int x, int y);
+    void WriteAt(const std::string &val, int x, int y);
     void WriteAt(int val, int x, int y);
     void WriteAt(float val, int x, int y);
     void WriteAt(double val, int x, int y);
@@ -131,7 +338,7 @@ public:
     ///@{
     /// @brief Write information to the screen and move to the next text line
     void WriteLine(const char *val);
-    void WriteLine(std::string val);
+    void WriteLine(const std::string &val);
     void WriteLine(int    val);
     void WriteLine(float  val);
     void WriteLine(double val);
@@ -157,6 +364,46 @@ private:
     void _Initialize();
     void _Clear();
 
+    /// @brief Open the window at a size, which becomes the screen size
+    void OpenWindow(int width, int height);
+
+    // Keyboard and mouse as of the last Update()
+    struct InputState
+    {
+        bool held[256], pressed[256], released[256];
+        int mouseX, mouseY, mouseButtons;
+        int lastChar;
+    };
+
+    // Defined in FEHLCD.cpp
+    struct RenderThread;
+
+    /// @brief Read a window's input after tigrUpdate(), adding its presses and releases to the ones already in state
+    static void ReadInput(Tigr *window, InputState *state);
+
+    /// @brief Move the events queued by the last tigrUpdate() into _events
+    void ReadEvents();
+
+    /// @brief Update input state with an event, the way tigr would have
+    static void ApplyEvent(const TigrEvent &e, InputState *state);
+
+    /// @brief Play back the script's commands for the frame just shown, when headless
+    void RunScript();
+
+    /// @brief Turn an input event from tigr into an FEHEvent queued for PollEvent()
+    void QueueEvent(const TigrEvent &e);
+
+    /// @brief Give the finished frame to the render thread and take the input it saw since the last Update()
+    /// @note Waits for the previous frame to be taken first, unless the present mode doesn't follow the display
+    void HandOff();
+
+    /// @brief Set the swap interval on whichever thread presents, see tigrSetSwapInterval()
+    bool SetSwapInterval(int interval);
+
+    /// @brief Run the recorded draw calls, if any, so that screen holds everything drawn so far
+    /// @note FEHImage calls this before freeing a bitmap a recorded call may still read
+    void Flush();
+
     void WriteChar(int row, int col, char c);
     void WriteCharAt(int x, int y, char c);
 
@@ -176,6 +423,47 @@ private:
     unsigned int _forecolor;
     unsigned int _backcolor;
 
+    // Frames shown so far
+    int _frame;
+
+    // Frame pacing; _nextFrame is the tigrClock() time the next frame is due when capped
+    FEHPresentMode _presentMode;
+    double _framePeriod;
+    double _nextFrame;
+
+    // Input events waiting for PollEvent(), oldest first
+    FEHEvent _events[FEH_MAX_EVENTS];
+    int _firstEvent;
+    int _numEvents;
+
+    InputState _input;
+
+    // NULL unless tracing latency
+    FEHLatency *latency;
+
+    // NULL unless profiling; the frame count to end the program at when benchmarking, or 0
+    FEHProfile *profile;
+    int _benchFrames;
+
+    // NULL unless presenting from a render thread
+    RenderThread *_render;
+
+    // NULL unless recording draw calls, see SetDrawThreads()
+    FEHDrawList *drawList;
+
+    // NULL unless recording frames, see StartRecording()
+    FEHRecorder *recorder;
+
+    // Reset at the end of every Update(), see FrameArena()
+    FEHArena frameArena;
+
+    // Running without a window; the script's input and screenshots, and when the last screenshot was taken
+    bool _headless;
+    FEHScript *_script;
+    bool _quit;
+    int _shotFrame;
+    double _shotTime;
+
 
     TPixel tigr_forecolor() { return FEH2Tigr(_forecolor); }
     TPixel tigr_backcolor() { return FEH2Tigr(_backcolor); }
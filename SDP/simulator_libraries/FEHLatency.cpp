@@ -0,0 +1,121 @@
+/// @file FEHLatency.cpp
+/// @brief Input-to-photon latency samples
+
+#include "FEHLatency.h"
+#include "FEHUtility.h"
+#include <iostream>
+#include <stdio.h>
+#include <algorithm>
+
+FEHLatency::FEHLatency(int cap)
+{
+	capacity = cap > 0 ? cap : 1;
+	inputTime = new double[capacity];
+	reactTime = new double[capacity];
+	presentTime = new double[capacity];
+	Clear();
+}
+
+FEHLatency::~FEHLatency()
+{
+	delete[] inputTime;
+	delete[] reactTime;
+	delete[] presentTime;
+}
+
+void FEHLatency::Clear()
+{
+	count = 0;
+	dropped = 0;
+	pendingInput = -1;
+	reactFrame = -1;
+}
+
+void FEHLatency::Input(double time)
+{
+	if (pendingInput < 0)
+	{
+		pendingInput = time;
+	}
+}
+
+void FEHLatency::React(int frame, double time)
+{
+	// Reactions with no input behind them (or a second one on the same frame) have nothing to measure
+	if (pendingInput < 0 || reactFrame >= 0)
+	{
+		return;
+	}
+
+	reactFrame = frame;
+	reactInput = pendingInput;
+	reactAt = time;
+	pendingInput = -1;
+}
+
+void FEHLatency::Present(int frame, double time)
+{
+	if (reactFrame < 0 || reactFrame > frame)
+	{
+		return;
+	}
+
+	if (count < capacity)
+	{
+		inputTime[count] = reactInput;
+		reactTime[count] = reactAt;
+		presentTime[count] = time;
+		count++;
+	}
+	else
+	{
+		dropped++;
+	}
+	reactFrame = -1;
+}
+
+// Print one row of the table from unsorted durations in seconds
+static void printStage(const char *name, double *ms, int n)
+{
+	std::sort(ms, ms + n);
+	printf("  %-20s %8.2f %8.2f %8.2f %8.2f %8.2f\n", name,
+		   ms[0], ms[n / 2], ms[(n * 90) / 100], ms[(n * 99) / 100], ms[n - 1]);
+}
+
+void FEHLatency::Print()
+{
+	if (count == 0)
+	{
+		std::cout << CONSOLE_WARN("No latency samples: call LCD.Reacted() when the game reacts to input\n");
+		return;
+	}
+
+	printf("Latency of %d inputs in ms", count);
+	if (dropped > 0)
+	{
+		printf(" (%d more not kept)", dropped);
+	}
+	printf("\n  %-20s %8s %8s %8s %8s %8s\n", "", "min", "median", "p90", "p99", "max");
+
+	double *ms = new double[count];
+
+	for (int i = 0; i < count; i++)
+	{
+		ms[i] = (reactTime[i] - inputTime[i]) * 1000.0;
+	}
+	printStage("input to reaction", ms, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		ms[i] = (presentTime[i] - reactTime[i]) * 1000.0;
+	}
+	printStage("reaction to present", ms, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		ms[i] = (presentTime[i] - inputTime[i]) * 1000.0;
+	}
+	printStage("input to present", ms, count);
+
+	delete[] ms;
+}
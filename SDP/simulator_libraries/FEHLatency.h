@@ -0,0 +1,58 @@
+#ifndef FEHLATENCY_H
+#define FEHLATENCY_H
+
+/// @brief Input-to-photon latency samples and their distribution
+/// @note FEHLCD fills one in while latency tracing is on, see FEHLCD::TraceLatency().
+/// Each sample follows one input from the moment it happened, to the frame on which the game
+/// reacted to it, to the moment that frame was on screen.
+class FEHLatency
+{
+	public:
+		/// @param capacity Maximum number of samples kept; later ones are counted but dropped
+		FEHLatency(int capacity = 4096);
+
+		~FEHLatency();
+
+		/// @brief Note an input (a press or a release) that the game may react to
+		/// @param time When the input happened, on tigrClock()
+		/// @note Only the oldest input since the last reaction is kept, since that is the one that waited longest
+		void Input(double time);
+
+		/// @brief The game reacted to the noted input
+		/// @param frame Frame the reaction will be shown on
+		/// @param time When the game reacted, on tigrClock()
+		void React(int frame, double time);
+
+		/// @brief A frame is now on screen, which completes the sample of a reaction shown on it
+		/// @param frame Frame that was presented
+		/// @param time When the present completed, on tigrClock()
+		void Present(int frame, double time);
+
+		/// @brief Forget every sample
+		void Clear();
+
+		/// @brief Number of samples kept
+		int Count() { return count; }
+
+		/// @brief Print the minimum, median, 90th and 99th percentile and maximum of each stage, in milliseconds
+		void Print();
+
+	private:
+		FEHLatency(const FEHLatency &);
+		FEHLatency &operator=(const FEHLatency &);
+
+		// Completed samples
+		double *inputTime, *reactTime, *presentTime;
+		int capacity;
+		int count;
+		int dropped;
+
+		// Oldest input not reacted to yet, or a negative time
+		double pendingInput;
+
+		// Reaction waiting for its frame to be presented, or a negative frame
+		int reactFrame;
+		double reactInput, reactAt;
+};
+
+#endif // FEHLATENCY_H
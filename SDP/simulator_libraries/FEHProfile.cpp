@@ -0,0 +1,107 @@
+/// @file FEHProfile.cpp
+/// @brief Time per phase of a frame, allocations and memory use
+
+#include "FEHProfile.h"
+#include "FEHAlloc.h"
+#include "tigr.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+FEHProfile::FEHProfile()
+{
+	phases = 0;
+	current = -1;
+	since = start = 0;
+	frames = 0;
+	allocations = allocated = 0;
+}
+
+void FEHProfile::Phase(const char *name, double time)
+{
+	if (current < 0)
+	{
+		start = time;
+		allocations = FEHAlloc::Count();
+		allocated = FEHAlloc::Bytes();
+	}
+	else
+	{
+		seconds[current] += time - since;
+	}
+	since = time;
+
+	for (current = 0; current < phases; current++)
+	{
+		if (strcmp(names[current], name) == 0)
+		{
+			return;
+		}
+	}
+	if (phases == MAX_PHASES)
+	{
+		// Out of room: the rest share the last one
+		current = phases - 1;
+		return;
+	}
+	names[phases] = name;
+	seconds[phases] = 0;
+	phases++;
+}
+
+// Most memory the program has had at once, in bytes, or -1 where that can't be asked
+static double peakMemory()
+{
+#ifdef _WIN32
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return -1;
+	}
+#ifdef __APPLE__
+	return usage.ru_maxrss;
+#else
+	return usage.ru_maxrss * 1024.0;
+#endif
+#endif
+}
+
+void FEHProfile::Print(double time)
+{
+	if (current < 0 || frames == 0)
+	{
+		printf("Profile: no frames measured\n");
+		return;
+	}
+
+	double total = time - start;
+	double perFrame = total / frames;
+	printf("Profile over %d frames, %.3f s: %.1f frames/s, %.3f ms/frame\n", frames, total, frames / total, perFrame * 1000.0);
+	for (int i = 0; i < phases; i++)
+	{
+		double phase = seconds[i] + (i == current ? time - since : 0);
+		printf("  %-12s %10.3f ms/frame %6.1f%%\n", names[i], phase * 1000.0 / frames, phase * 100.0 / total);
+	}
+
+	if (FEHAlloc::Available())
+	{
+		long count = FEHAlloc::Count() - allocations;
+		long bytes = FEHAlloc::Bytes() - allocated;
+		printf("  %-12s %10.2f /frame %12.0f bytes/frame (%ld in all)\n", "allocations", (double)count / frames, (double)bytes / frames, count);
+	}
+
+	TigrPoolStats pool;
+	tigrPoolStats(&pool);
+	printf("  %-12s %10ld of %ld reused, %ld in use, %ld pooled (%.1f MB)\n", "bitmaps", pool.reused, pool.allocations, pool.inUse, pool.pooled, pool.pooledBytes / (1024.0 * 1024.0));
+
+	double peak = peakMemory();
+	if (peak >= 0)
+	{
+		printf("  %-12s %10.1f MB\n", "peak memory", peak / (1024.0 * 1024.0));
+	}
+}
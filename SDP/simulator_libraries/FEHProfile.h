@@ -0,0 +1,43 @@
+#ifndef FEHPROFILE_H
+#define FEHPROFILE_H
+
+/// @brief Where the time of each frame goes, split into named phases
+/// @note FEHLCD fills one in while profiling is on, see FEHLCD::Profile(). Time is charged to whichever phase
+/// was started last, so the phases always add up to the whole run; a phase may be started many times a frame.
+class FEHProfile
+{
+	public:
+		FEHProfile();
+
+		/// @brief End the current phase and start another
+		/// @param name Name of the phase; the first call starts the run being measured
+		/// @param time Now, on tigrClock()
+		void Phase(const char *name, double time);
+
+		/// @brief A frame has ended
+		void Frame() { frames++; }
+
+		/// @brief Number of frames since the run started
+		int Frames() { return frames; }
+
+		/// @brief Print frames per second, each phase's share of a frame, allocations per frame and peak memory use
+		/// @param time Now, on tigrClock()
+		void Print(double time);
+
+	private:
+		static const int MAX_PHASES = 16;
+
+		const char *names[MAX_PHASES];
+		double seconds[MAX_PHASES];
+		int phases;
+
+		// Phase being timed and when it started, or -1 before the run starts
+		int current;
+		double since;
+
+		double start;
+		int frames;
+		long allocations, allocated;
+};
+
+#endif // FEHPROFILE_H
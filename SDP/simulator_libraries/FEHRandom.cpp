@@ -16,6 +16,14 @@ void FEHRandom::Seed()
 	RandInt();
 }
 
+void FEHRandom::Seed(unsigned int seed)
+{
+	srand(seed);
+	RandInt();
+	RandInt();
+	RandInt();
+}
+
 int FEHRandom::RandInt()
 {
 	// We specify in documentation rand will be between 0 and 32767
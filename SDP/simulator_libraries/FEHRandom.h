@@ -9,6 +9,9 @@ public:
 	/// @brief Seed the random number generator
 	void Seed();
 
+	/// @brief Seed the random number generator with a fixed value, so every run gets the same numbers
+	void Seed(unsigned int seed);
+
 	/// @brief Get a random integer between 0 and 32767
 	int RandInt();
 };
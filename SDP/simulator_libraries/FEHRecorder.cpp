@@ -0,0 +1,223 @@
+/// @file FEHRecorder.cpp
+/// @brief Frames written to disk by a background thread
+
+#include "FEHRecorder.h"
+#include "FEHUtility.h"
+#include <iostream>
+#include <string.h>
+
+// A pattern may have one conversion, and it must be a plain number
+static bool validPattern(const std::string &pattern)
+{
+	size_t percent = pattern.find('%');
+	if (percent == std::string::npos)
+	{
+		return false;
+	}
+
+	size_t end = percent + 1;
+	while (end < pattern.size() && pattern[end] >= '0' && pattern[end] <= '9')
+	{
+		end++;
+	}
+	return end < pattern.size() && pattern[end] == 'd' && pattern.find('%', end) == std::string::npos;
+}
+
+FEHRecorder::FEHRecorder(const char *p, int w, int h, int fps, int buffers)
+{
+	path = p;
+	width = w;
+	height = h;
+	open = false;
+	file = NULL;
+	first = 0;
+	queued = 0;
+	captured = 0;
+	dropped = 0;
+	resized = 0;
+	late = 0;
+	written = 0;
+	failed = 0;
+	stopping = false;
+
+	video = path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+	if (video)
+	{
+		file = fopen(p, "wb");
+		if (!file)
+		{
+			std::cout << CONSOLE_ERR("(Recording) Could not open " << path) << std::endl;
+			return;
+		}
+		// 4:4:4 keeps the colors of single-pixel details such as text
+		fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, fps > 0 ? fps : 60);
+		planes.resize((size_t)width * height * 3);
+	}
+	else
+	{
+		if (path.find('%') == std::string::npos)
+		{
+			path += "%05d.png";
+		}
+		if (!validPattern(path))
+		{
+			std::cout << CONSOLE_ERR("(Recording) The file name needs exactly one %d for the frame number: " << path) << std::endl;
+			return;
+		}
+	}
+
+	if (buffers < 1)
+	{
+		buffers = 1;
+	}
+	for (int i = 0; i < buffers; i++)
+	{
+		ring.push_back(tigrBitmap(width, height));
+		numbers.push_back(0);
+	}
+
+	open = true;
+	writer = std::thread(&FEHRecorder::Write, this);
+}
+
+FEHRecorder::~FEHRecorder()
+{
+	Stop();
+
+	for (size_t i = 0; i < ring.size(); i++)
+	{
+		tigrFree(ring[i]);
+	}
+}
+
+void FEHRecorder::Stop()
+{
+	if (writer.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		ready.notify_one();
+		writer.join();
+	}
+
+	if (file)
+	{
+		fclose(file);
+		file = NULL;
+	}
+	open = false;
+}
+
+bool FEHRecorder::Capture(Tigr *frame)
+{
+	int number = captured++;
+	if (!open)
+	{
+		late++;
+		return false;
+	}
+	if (frame->w != width || frame->h != height)
+	{
+		resized++;
+		return false;
+	}
+
+	int slot;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (queued == (int)ring.size())
+		{
+			dropped++;
+			return false;
+		}
+		slot = (first + queued) % ring.size();
+	}
+
+	// The writer only reads slots counted in queued, so this one can be filled without the lock
+	memcpy(ring[slot]->pix, frame->pix, (size_t)width * height * sizeof(TPixel));
+	numbers[slot] = number;
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		queued++;
+	}
+	ready.notify_one();
+	return true;
+}
+
+void FEHRecorder::Write()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		ready.wait(guard, [this]() { return stopping || queued > 0; });
+		if (queued == 0)
+		{
+			return;
+		}
+		int slot = first;
+
+		guard.unlock();
+		bool ok = video ? WriteY4M(ring[slot]) : WritePNG(ring[slot], numbers[slot]);
+		guard.lock();
+
+		first = (first + 1) % ring.size();
+		queued--;
+		if (ok)
+		{
+			written++;
+		}
+		else
+		{
+			failed++;
+		}
+	}
+}
+
+bool FEHRecorder::WriteY4M(Tigr *frame)
+{
+	// BT.601 with studio range, which is what players assume for Y4M without a color tag
+	size_t n = (size_t)width * height;
+	unsigned char *y = &planes[0], *cb = y + n, *cr = cb + n;
+	for (size_t i = 0; i < n; i++)
+	{
+		int r = frame->pix[i].r, g = frame->pix[i].g, b = frame->pix[i].b;
+		y[i] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		cb[i] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		cr[i] = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+
+	return fputs("FRAME\n", file) >= 0 && fwrite(&planes[0], 1, planes.size(), file) == planes.size();
+}
+
+bool FEHRecorder::WritePNG(Tigr *frame, int number)
+{
+	char name[1024];
+	snprintf(name, sizeof(name), path.c_str(), number);
+	return tigrSaveImage(name, frame) != 0;
+}
+
+void FEHRecorder::Print()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	printf("Recorded %d of %d frames to %s", written, captured, path.c_str());
+	if (dropped > 0)
+	{
+		printf(", %d dropped because the writer fell behind", dropped);
+	}
+	if (resized > 0)
+	{
+		printf(", %d dropped for not being %dx%d", resized, width, height);
+	}
+	if (late > 0)
+	{
+		printf(", %d dropped with the output closed", late);
+	}
+	printf("\n");
+	if (failed > 0)
+	{
+		std::cout << CONSOLE_ERR("(Recording) " << failed << " frames could not be written") << std::endl;
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef FEHRECORDER_H
+#define FEHRECORDER_H
+
+#include "tigr.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// @brief Frames copied into a ring of preallocated bitmaps and written to disk by a background thread
+/// @note FEHLCD gives it every frame while recording, see FEHLCD::StartRecording(). Capture() never waits
+/// for the writer: when every buffer is still waiting to be written, the frame is dropped and counted instead.
+class FEHRecorder
+{
+	public:
+		/// @param path A file ending in ".y4m" for one video, or a pattern for numbered PNGs with one %d in it,
+		/// e.g. "rec/frame%05d.png"; without a %d, the number and ".png" are added to the end
+		/// @param width Width of every frame
+		/// @param height Height of every frame
+		/// @param fps Frame rate written into a video's header
+		/// @param buffers Number of frames that can wait for the writer
+		FEHRecorder(const char *path, int width, int height, int fps, int buffers = 8);
+
+		~FEHRecorder();
+
+		/// @brief Whether the output could be opened; nothing is recorded otherwise
+		bool IsOpen() { return open; }
+
+		/// @brief Copy a frame into the ring for the writer
+		/// @return false if the frame was dropped, because the ring is full, it is the wrong size or the output is closed
+		bool Capture(Tigr *frame);
+
+		/// @brief Wait for the frames in the ring to be written, then close the output; later frames are dropped
+		void Stop();
+
+		/// @brief Number of frames given to Capture()
+		int Captured() { return captured; }
+
+		/// @brief Number of frames dropped by Capture(), for any reason
+		int Dropped() { return dropped + resized + late; }
+
+		/// @brief Print how many frames were written, and how many were dropped for each reason
+		void Print();
+
+	private:
+		FEHRecorder(const FEHRecorder &);
+		FEHRecorder &operator=(const FEHRecorder &);
+
+		/// @brief Write frames from the ring until told to stop and the ring is empty
+		void Write();
+
+		/// @brief Append one frame to the video as 8-bit 4:4:4 YCbCr
+		bool WriteY4M(Tigr *frame);
+
+		/// @brief Write one frame as its own PNG
+		bool WritePNG(Tigr *frame, int number);
+
+		std::string path;
+		bool open, video;
+		int width, height;
+
+		// Video output, and one frame of it converted to planes
+		FILE *file;
+		std::vector<unsigned char> planes;
+
+		// Frames ring[first] and on are waiting for the writer, queued of them; numbers[] says which frame each is
+		std::vector<Tigr *> ring;
+		std::vector<int> numbers;
+		int first, queued;
+
+		int captured, written, failed;
+
+		// Frames dropped because the ring was full, because they were not the size being recorded,
+		// and because the output was closed (never opened, or after Stop())
+		int dropped, resized, late;
+
+		std::thread writer;
+		std::mutex lock;
+		std::condition_variable ready;
+		bool stopping;
+};
+
+#endif // FEHRECORDER_H
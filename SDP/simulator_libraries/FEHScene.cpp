@@ -0,0 +1,106 @@
+/// @file FEHScene.cpp
+/// @brief Scene switching and per-scene image sets
+
+#include "FEHScene.h"
+#include "FEHUtility.h"
+
+FEHAssets::FEHAssets(int cap)
+{
+	capacity = cap > 0 ? cap : 1;
+	images = new FEHImage[capacity];
+	count = 0;
+}
+
+FEHAssets::~FEHAssets()
+{
+	delete[] images;
+}
+
+FEHImage *FEHAssets::Load(const char *filename)
+{
+	if (count == capacity)
+	{
+		std::cout << CONSOLE_ERR("Cannot load [" << CONSOLE_BLUE(filename) << "], the scene already holds " << CONSOLE_GREEN(capacity) << " images! Raise its maxAssets\n");
+		return &missing;
+	}
+
+	images[count].Open(filename);
+	return &images[count++];
+}
+
+void FEHAssets::Release()
+{
+	for (int i = 0; i < count; i++)
+	{
+		images[i] = FEHImage();
+	}
+	count = 0;
+}
+
+FEHSceneManager::FEHSceneManager(int max)
+{
+	maxScenes = max > 0 ? max : 1;
+	scenes = new FEHScene *[maxScenes]();
+	current = -1;
+}
+
+FEHSceneManager::~FEHSceneManager()
+{
+	delete[] scenes;
+}
+
+void FEHSceneManager::Add(int id, FEHScene *scene)
+{
+	if (id < 0 || id >= maxScenes)
+	{
+		std::cout << CONSOLE_ERR("Scene id " << CONSOLE_BLUE(id) << " is out of range! Use ids from 0 to " << CONSOLE_GREEN(maxScenes - 1) << "\n");
+		return;
+	}
+
+	scenes[id] = scene;
+}
+
+void FEHSceneManager::Run(int id)
+{
+	Switch(id);
+	while (1)
+	{
+		Step();
+	}
+}
+
+void FEHSceneManager::Switch(int id)
+{
+	if (id < 0 || id >= maxScenes || !scenes[id])
+	{
+		std::cout << CONSOLE_ERR("No scene was added with id " << CONSOLE_BLUE(id) << "\n");
+		return;
+	}
+
+	if (current >= 0)
+	{
+		scenes[current]->Exit();
+		scenes[current]->assets.Release();
+	}
+
+	current = id;
+	scenes[current]->Enter();
+}
+
+void FEHSceneManager::Step()
+{
+	if (current < 0)
+	{
+		return;
+	}
+
+	FEHScene *scene = scenes[current];
+	int next = scene->Update();
+	scene->Draw();
+	LCD.Update();
+
+	if (next != FEH_SCENE_STAY && next != current)
+	{
+		Switch(next);
+	}
+}
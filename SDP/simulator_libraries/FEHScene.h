@@ -0,0 +1,113 @@
+#ifndef FEHSCENE_H
+#define FEHSCENE_H
+
+#include "FEHImages.h"
+
+/// @brief Returned from FEHScene::Update() to keep showing the same scene
+#define FEH_SCENE_STAY -1
+
+/// @brief Fixed-size set of images that are freed together
+class FEHAssets
+{
+	public:
+		/// @brief Create an empty set
+		/// @param capacity Maximum number of images in the set
+		FEHAssets(int capacity);
+
+		~FEHAssets();
+
+		/// @brief Open an image and keep it in the set
+		/// @param filename The name of the file to open
+		/// @return The opened image, valid until Release(). If the set is full an error is printed and an empty image is returned
+		FEHImage *Load(const char *filename);
+
+		/// @brief Free every image in the set
+		/// @note Pointers returned by Load() keep pointing at the now empty images. Copies of them keep their image alive
+		void Release();
+
+		/// @brief Number of images in the set
+		int Count() { return count; }
+
+	private:
+		FEHAssets(const FEHAssets &);
+		FEHAssets &operator=(const FEHAssets &);
+
+		FEHImage *images;
+		int capacity;
+		int count;
+
+		// Handed out once the set is full
+		FEHImage missing;
+};
+
+/// @brief One screen of a program (menu, game, credits, ...)
+/// @note Subclasses load what they need in Enter() through the assets member, which is released
+/// automatically after Exit(). Update() and Draw() should not open files, so nothing is loaded per frame
+/// and only the active scene's images are in memory.
+class FEHScene
+{
+	public:
+		/// @param maxAssets Maximum number of images the scene can load at once
+		FEHScene(int maxAssets = 16) : assets(maxAssets) {}
+
+		virtual ~FEHScene() {}
+
+		/// @brief Called when the scene becomes active; load assets and reset state here
+		virtual void Enter() {}
+
+		/// @brief Called when another scene takes over, before the scene's assets are released
+		virtual void Exit() {}
+
+		/// @brief Advance the scene by one frame
+		/// @return Id of the scene to show from the next frame on, or FEH_SCENE_STAY
+		virtual int Update() = 0;
+
+		/// @brief Draw the current frame; called after Update()
+		virtual void Draw() {}
+
+	protected:
+		/// @brief Images loaded while the scene is active
+		FEHAssets assets;
+
+	private:
+		friend class FEHSceneManager;
+};
+
+/// @brief Runs one scene at a time and switches between them
+class FEHSceneManager
+{
+	public:
+		/// @brief Create a manager for scene ids 0 to maxScenes - 1
+		FEHSceneManager(int maxScenes = 16);
+
+		~FEHSceneManager();
+
+		/// @brief Make a scene available under an id
+		/// @param id Id that Update() functions return to switch to the scene
+		/// @param scene Scene to run; not owned by the manager and must outlive it
+		void Add(int id, FEHScene *scene);
+
+		/// @brief Activate the first scene and run frames forever
+		/// @param id Id of the first scene
+		void Run(int id);
+
+		/// @brief Activate a scene, leaving the current one (if any)
+		/// @param id Id passed to Add()
+		void Switch(int id);
+
+		/// @brief Run one frame: update and draw the active scene, show it, then switch scenes if it asked to
+		void Step();
+
+		/// @brief Id of the active scene, or -1 before the first Switch()
+		int Current() { return current; }
+
+	private:
+		FEHSceneManager(const FEHSceneManager &);
+		FEHSceneManager &operator=(const FEHSceneManager &);
+
+		FEHScene **scenes;
+		int maxScenes;
+		int current;
+};
+
+#endif // FEHSCENE_H
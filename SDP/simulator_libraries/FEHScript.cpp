@@ -0,0 +1,199 @@
+/// @file FEHScript.cpp
+/// @brief Scripted input for headless runs
+
+#include "FEHScript.h"
+#include "FEHUtility.h"
+#include "tigr.h"
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+// Key codes by name, as tigr numbers them
+static const struct
+{
+	const char *name;
+	int key;
+} keyNames[] = {
+	{"space", TK_SPACE}, {"enter", TK_RETURN}, {"escape", TK_ESCAPE}, {"backspace", TK_BACKSPACE},
+	{"tab", TK_TAB}, {"shift", TK_SHIFT}, {"control", TK_CONTROL}, {"alt", TK_ALT},
+	{"up", TK_UP}, {"down", TK_DOWN}, {"left", TK_LEFT}, {"right", TK_RIGHT},
+};
+
+static int parseKey(const char *name)
+{
+	// Letters and digits are their own (upper case) codes
+	if (name[0] && !name[1] && isalnum((unsigned char)name[0]))
+	{
+		return toupper((unsigned char)name[0]);
+	}
+	for (size_t i = 0; i < sizeof(keyNames) / sizeof(keyNames[0]); i++)
+	{
+		if (strcmp(name, keyNames[i].name) == 0)
+		{
+			return keyNames[i].key;
+		}
+	}
+	return 0;
+}
+
+FEHScript::FEHScript()
+{
+	next = 0;
+	offset = 0;
+}
+
+bool FEHScript::Load(const char *path)
+{
+	commands.clear();
+	next = 0;
+	offset = 0;
+
+	FILE *file = fopen(path, "r");
+	if (!file)
+	{
+		std::cout << CONSOLE_ERR("(Script) Could not open " << path) << std::endl;
+		return false;
+	}
+
+	char line[1024];
+	int number = 0;
+	bool ok = true;
+	while (ok && fgets(line, sizeof(line), file))
+	{
+		number++;
+		char *comment = strchr(line, '#');
+		if (comment)
+		{
+			*comment = '\0';
+		}
+
+		Command c;
+		char word[32], arg[1000];
+		int n = sscanf(line, "%d %31s", &c.frame, word);
+		if (n <= 0)
+		{
+			continue; // blank
+		}
+
+		c.x = c.y = c.key = 0;
+		if (n == 2 && strcmp(word, "move") == 0)
+		{
+			c.type = MOVE;
+			ok = sscanf(line, "%*d %*s %d %d", &c.x, &c.y) == 2;
+		}
+		else if (n == 2 && strcmp(word, "down") == 0)
+		{
+			c.type = DOWN;
+			ok = sscanf(line, "%*d %*s %d %d", &c.x, &c.y) == 2;
+		}
+		else if (n == 2 && strcmp(word, "up") == 0)
+		{
+			c.type = UP;
+			ok = sscanf(line, "%*d %*s %d %d", &c.x, &c.y) == 2;
+		}
+		else if (n == 2 && strcmp(word, "click") == 0)
+		{
+			c.type = CLICK;
+			ok = sscanf(line, "%*d %*s %d %d", &c.x, &c.y) == 2;
+		}
+		else if (n == 2 && strcmp(word, "key") == 0)
+		{
+			char state[8];
+			ok = sscanf(line, "%*d %*s %999s %7s", arg, state) == 2 && (c.key = parseKey(arg)) != 0 &&
+				 (strcmp(state, "down") == 0 || strcmp(state, "up") == 0);
+			c.type = ok && strcmp(state, "down") == 0 ? KEY_DOWN : KEY_UP;
+		}
+		else if (n == 2 && strcmp(word, "shot") == 0)
+		{
+			c.type = SHOT;
+			ok = sscanf(line, "%*d %*s %999s", arg) == 1;
+			c.path = arg;
+		}
+		else if (n == 2 && strcmp(word, "quit") == 0)
+		{
+			c.type = QUIT;
+		}
+		else if (n == 2 && strcmp(word, "repeat") == 0)
+		{
+			// Going back to its own frame or later would never move on. Without a count it repeats forever,
+			// which y holds as -1; key counts down the repeats left
+			c.type = REPEAT;
+			int read = sscanf(line, "%*d %*s %d %d", &c.x, &c.y);
+			ok = read >= 1 && c.x < c.frame && (read == 1 || c.y > 0);
+			if (read == 1)
+			{
+				c.y = -1;
+			}
+			c.key = c.y;
+		}
+		else
+		{
+			ok = false;
+		}
+
+		if (ok && !commands.empty() && c.frame < commands.back().frame)
+		{
+			std::cout << CONSOLE_ERR("(Script) " << path << ":" << number << ": commands must be in order of frame") << std::endl;
+			fclose(file);
+			commands.clear();
+			return false;
+		}
+		if (ok)
+		{
+			commands.push_back(c);
+		}
+	}
+	fclose(file);
+
+	if (!ok)
+	{
+		std::cout << CONSOLE_ERR("(Script) " << path << ":" << number << ": could not read the command") << std::endl;
+		commands.clear();
+	}
+	return ok;
+}
+
+bool FEHScript::Next(int frame, Command *command)
+{
+	while (next < commands.size() && commands[next].frame + offset <= frame)
+	{
+		Command c = commands[next++];
+		c.frame += offset;
+		if (c.type != REPEAT)
+		{
+			*command = c;
+			return true;
+		}
+
+		// Once its count is used up, carry on with what follows it
+		Command &repeat = commands[next - 1];
+		if (repeat.key == 0)
+		{
+			continue;
+		}
+		if (repeat.key > 0)
+		{
+			repeat.key--;
+		}
+
+		// Back to the first command on or after the repeated frame, which now comes on this one
+		size_t end = next - 1;
+		offset = c.frame - c.x;
+		next = 0;
+		while (commands[next].frame < c.x)
+		{
+			next++;
+		}
+
+		// Repeats inside the part played again start their counts over
+		for (size_t i = next; i < end; i++)
+		{
+			if (commands[i].type == REPEAT)
+			{
+				commands[i].key = commands[i].y;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,56 @@
+#ifndef FEHSCRIPT_H
+#define FEHSCRIPT_H
+
+#include <string>
+#include <vector>
+
+/// @brief Input and screenshots for a headless run, read from a text file
+/// @note FEHLCD plays one back when the FEH_SCRIPT environment variable names it, see FEHLCD::IsHeadless().
+/// There is one command per line, and "#" starts a comment. Each command starts with the frame it happens
+/// on, counting Update() calls from 1; input given on frame n is seen by the game after its nth Update().
+/// Commands must be in order of frame.
+/// - `<frame> move <x> <y>` moves the mouse
+/// - `<frame> down <x> <y>` and `<frame> up <x> <y>` press and let go of the left button there
+/// - `<frame> click <x> <y>` presses and lets go in the same frame
+/// - `<frame> key <name> down` and `<frame> key <name> up` press and let go of a key: a letter or digit,
+/// or one of space, enter, escape, backspace, tab, shift, control, alt, up, down, left, right
+/// - `<frame> shot <file>` saves the frame as a PNG, see FEHLCD::Screenshot()
+/// - `<frame> quit` ends the program after the frame, as closing the window does
+/// - `<frame> repeat <from> [<times>]` plays the commands from frame `from` on again, starting this frame. Without a
+/// count it does so forever and commands after it are never reached; with one, the commands after it follow the last
+/// time through, later by however much the repeats took
+class FEHScript
+{
+	public:
+		enum Type { MOVE, DOWN, UP, CLICK, KEY_DOWN, KEY_UP, SHOT, QUIT, REPEAT };
+
+		struct Command
+		{
+			int frame;
+			Type type;
+			int x, y, key;
+			std::string path;
+		};
+
+		FEHScript();
+
+		/// @brief Read a script, replacing any read before
+		/// @return false if the file can't be read or a line doesn't parse, which is printed
+		bool Load(const char *path);
+
+		/// @brief Take the next command for a frame
+		/// @return false once every command up to and including that frame has been taken
+		bool Next(int frame, Command *command);
+
+		/// @brief Whether every command has been taken
+		bool Done() { return next == commands.size(); }
+
+	private:
+		std::vector<Command> commands;
+		size_t next;
+
+		// Added to every command's frame since the last repeat
+		int offset;
+};
+
+#endif // FEHSCRIPT_H
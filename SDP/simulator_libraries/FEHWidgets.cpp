@@ -0,0 +1,464 @@
+/// @file FEHWidgets.cpp
+/// @brief Retained widgets that only repaint when their state changes
+
+#include "FEHWidgets.h"
+#include "FEHUtility.h"
+#include <stdio.h>
+#include <algorithm>
+
+FEHWidget::FEHWidget(int x, int y, int width, int height)
+	: x(x), y(y), width(width), height(height), dirty(true)
+{
+}
+
+/*
+	FEHLabel
+*/
+FEHLabel::FEHLabel(int x, int y, const char *str, unsigned int c, int maxLen)
+	: FEHWidget(x, y, 0, CHAR_HEIGHT)
+{
+	maxLength = maxLen > 0 ? maxLen : (int)strlen(str);
+	if (maxLength < 1)
+	{
+		maxLength = 1;
+	}
+	width = maxLength * CHAR_WIDTH;
+	text = new char[maxLength + 1];
+	text[0] = '\0';
+	color = c;
+	SetText(str);
+}
+
+FEHLabel::~FEHLabel()
+{
+	delete[] text;
+}
+
+void FEHLabel::SetText(const char *str)
+{
+	if (strncmp(text, str, maxLength) != 0)
+	{
+		strncpy(text, str, maxLength);
+		text[maxLength] = '\0';
+		Invalidate();
+	}
+}
+
+void FEHLabel::SetText(int value)
+{
+	char str[16];
+	sprintf(str, "%d", value);
+	SetText(str);
+}
+
+void FEHLabel::SetColor(unsigned int c)
+{
+	if (color != c)
+	{
+		color = c;
+		Invalidate();
+	}
+}
+
+void FEHLabel::Paint()
+{
+	LCD.SetFontColor(color);
+	LCD.WriteAt(text, x, y);
+}
+
+/*
+	FEHPicture
+*/
+FEHPicture::FEHPicture(int x, int y, FEHImage *img)
+	: FEHWidget(x, y, 0, 0), image(NULL)
+{
+	SetImage(img);
+}
+
+void FEHPicture::SetImage(FEHImage *img)
+{
+	image = img;
+	width = img ? img->Width() : 0;
+	height = img ? img->Height() : 0;
+	Invalidate();
+}
+
+void FEHPicture::Paint()
+{
+	if (image)
+	{
+		image->Draw(x, y);
+	}
+}
+
+/*
+	FEHButton
+*/
+FEHButton::FEHButton(int x, int y, int width, int height, const char *str, unsigned int c, unsigned int tc)
+	: FEHWidget(x, y, width, height), color(c), textColor(tc),
+	  pressed(false), clicked(false), toggle(false), selected(false)
+{
+	strncpy(label, str, sizeof(label) - 1);
+	label[sizeof(label) - 1] = '\0';
+}
+
+bool FEHButton::Clicked()
+{
+	bool was = clicked;
+	clicked = false;
+	return was;
+}
+
+void FEHButton::SetLabel(const char *str)
+{
+	if (strncmp(label, str, sizeof(label) - 1) != 0)
+	{
+		strncpy(label, str, sizeof(label) - 1);
+		label[sizeof(label) - 1] = '\0';
+		Invalidate();
+	}
+}
+
+void FEHButton::SetSelected(bool sel)
+{
+	if (selected != sel)
+	{
+		selected = sel;
+		Invalidate();
+	}
+}
+
+void FEHButton::Press(bool inside)
+{
+	if (pressed != inside)
+	{
+		pressed = inside;
+		Invalidate();
+	}
+}
+
+void FEHButton::Release(bool inside)
+{
+	Press(false);
+	if (inside)
+	{
+		clicked = true;
+		if (toggle)
+		{
+			SetSelected(!selected);
+		}
+	}
+}
+
+void FEHButton::Paint()
+{
+	LCD.SetFontColor(color);
+	LCD.DrawRectangle(x, y, width, height);
+
+	// Thick outline while held down or selected, like FEHIcon::Icon::Select()
+	if (pressed || selected)
+	{
+		LCD.DrawRectangle(x + 1, y + 1, width - 2, height - 2);
+		LCD.DrawRectangle(x + 2, y + 2, width - 4, height - 4);
+		LCD.DrawRectangle(x + 3, y + 3, width - 6, height - 6);
+	}
+
+	LCD.SetFontColor(textColor);
+	LCD.WriteAt(label, x + ((width - ((int)strlen(label) * CHAR_WIDTH)) / 2), y + ((height - CHAR_HEIGHT) / 2));
+}
+
+/*
+	FEHImageButton
+*/
+FEHImageButton::FEHImageButton(int x, int y, int width, int height, FEHImage *img, FEHImage *pressedImg)
+	: FEHWidget(x, y, width, height), image(img), pressedImage(pressedImg), pressed(false), clicked(false)
+{
+}
+
+void FEHImageButton::SetImages(FEHImage *img, FEHImage *pressedImg)
+{
+	image = img;
+	pressedImage = pressedImg;
+	Invalidate();
+}
+
+bool FEHImageButton::Clicked()
+{
+	bool was = clicked;
+	clicked = false;
+	return was;
+}
+
+void FEHImageButton::Press(bool inside)
+{
+	if (pressed != inside)
+	{
+		pressed = inside;
+		Invalidate();
+	}
+}
+
+void FEHImageButton::Release(bool inside)
+{
+	Press(false);
+	if (inside)
+	{
+		clicked = true;
+	}
+}
+
+void FEHImageButton::Paint()
+{
+	FEHImage *shown = pressed ? pressedImage : image;
+	if (shown)
+	{
+		shown->Draw(x, y);
+	}
+}
+
+/*
+	FEHIconGrid
+*/
+FEHIconGrid::FEHIconGrid(int rows, int cols, int top, int bot, int left, int right, const char labels[][20], unsigned int color, unsigned int textColor)
+{
+	rows = rows > 0 ? rows : 1;
+	cols = cols > 0 ? cols : 1;
+	count = rows * cols;
+	icons = new FEHButton *[count];
+
+	// Same layout as FEHIcon::DrawIconArray()
+	int w = (LCD.Width() - left - right) / cols;
+	int h = (LCD.Height() - top - bot) / rows;
+	for (int row = 0; row < rows; row++)
+	{
+		for (int col = 0; col < cols; col++)
+		{
+			int i = row * cols + col;
+			icons[i] = new FEHButton(left + col * w, top + row * h, w, h, labels[i], color, textColor);
+		}
+	}
+}
+
+FEHIconGrid::~FEHIconGrid()
+{
+	for (int i = 0; i < count; i++)
+	{
+		delete icons[i];
+	}
+	delete[] icons;
+}
+
+int FEHIconGrid::Clicked()
+{
+	int index = -1;
+	for (int i = 0; i < count; i++)
+	{
+		// Check every icon so no click is left over for the next call
+		if (icons[i]->Clicked())
+		{
+			index = i;
+		}
+	}
+	return index;
+}
+
+/*
+	FEHWidgetTree
+*/
+FEHWidgetTree::FEHWidgetTree(unsigned int bg, int cap)
+{
+	background = bg;
+	capacity = cap > 0 ? cap : 1;
+	widgets = new FEHWidget *[capacity];
+	hitLeft = new int[capacity];
+	hitTop = new int[capacity];
+	hitRight = new int[capacity];
+	hitBottom = new int[capacity];
+	hitWidget = new int[capacity];
+	count = 0;
+	hitCount = 0;
+	active = -1;
+	clearScreen = true;
+}
+
+FEHWidgetTree::~FEHWidgetTree()
+{
+	delete[] widgets;
+	delete[] hitLeft;
+	delete[] hitTop;
+	delete[] hitRight;
+	delete[] hitBottom;
+	delete[] hitWidget;
+}
+
+void FEHWidgetTree::Add(FEHWidget *widget)
+{
+	if (count == capacity)
+	{
+		std::cout << CONSOLE_ERR("FEHWidgetTree is full! Raise its capacity above " << CONSOLE_GREEN(capacity) << "\n");
+		return;
+	}
+
+	if (widget->Interactive())
+	{
+		hitLeft[hitCount] = widget->X();
+		hitTop[hitCount] = widget->Y();
+		hitRight[hitCount] = widget->X() + widget->Width();
+		hitBottom[hitCount] = widget->Y() + widget->Height();
+		hitWidget[hitCount] = count;
+		hitCount++;
+	}
+
+	widgets[count++] = widget;
+	widget->Invalidate();
+}
+
+void FEHWidgetTree::Add(FEHIconGrid *grid)
+{
+	for (int i = 0; i < grid->count; i++)
+	{
+		Add(grid->icons[i]);
+	}
+}
+
+void FEHWidgetTree::Invalidate()
+{
+	clearScreen = true;
+	for (int i = 0; i < count; i++)
+	{
+		widgets[i]->Invalidate();
+	}
+
+	// Let go of any touch in progress and forget input meant for whatever was on screen before.
+	// A touch that is still held only ends after this, so it counts as already handled
+	if (active >= 0)
+	{
+		widgets[active]->Press(false);
+		active = -1;
+	}
+	LCD.ClearEvents();
+}
+
+int FEHWidgetTree::HitTest(float x, float y)
+{
+	// Last added is on top, so search backwards
+	for (int i = hitCount - 1; i >= 0; i--)
+	{
+		if (x >= hitLeft[i] && x < hitRight[i] && y >= hitTop[i] && y < hitBottom[i])
+		{
+			return hitWidget[i];
+		}
+	}
+	return -1;
+}
+
+void FEHWidgetTree::Update()
+{
+	// Go through every event, so a click shorter than a frame still reaches its widget
+	FEHEvent event;
+	while (LCD.PollEvent(&event))
+	{
+		if (event.type == FEH_EVENT_TOUCH_DOWN)
+		{
+			// New touch: it belongs to whatever it started on for as long as it lasts
+			active = HitTest(event.x, event.y);
+		}
+
+		if (active < 0)
+		{
+			continue;
+		}
+
+		bool inside = HitTest(event.x, event.y) == active;
+		if (event.type == FEH_EVENT_TOUCH_UP)
+		{
+			widgets[active]->Release(inside);
+			active = -1;
+			LCD.Reacted();
+		}
+		else if (event.type == FEH_EVENT_TOUCH_DOWN || event.type == FEH_EVENT_TOUCH_MOVE)
+		{
+			widgets[active]->Press(inside);
+			if (event.type == FEH_EVENT_TOUCH_DOWN)
+			{
+				LCD.Reacted();
+			}
+		}
+	}
+}
+
+// Check if two widgets' rectangles overlap
+static bool overlap(FEHWidget *a, FEHWidget *b)
+{
+	return a->X() < b->X() + b->Width() && a->X() + a->Width() > b->X() &&
+		   a->Y() < b->Y() + b->Height() && a->Y() + a->Height() > b->Y();
+}
+
+int FEHWidgetTree::Draw()
+{
+	bool erase = true;
+	if (clearScreen)
+	{
+		LCD.SetFontColor(background);
+		LCD.FillRectangle(0, 0, LCD.Width() - 1, LCD.Height() - 1);
+		clearScreen = false;
+		erase = false;
+	}
+
+	// Erasing a widget damages everything it overlaps, so those have to be repainted too
+	bool grew = true;
+	while (grew)
+	{
+		grew = false;
+		for (int i = 0; i < count; i++)
+		{
+			if (!widgets[i]->dirty)
+			{
+				continue;
+			}
+			for (int j = 0; j < count; j++)
+			{
+				if (!widgets[j]->dirty && overlap(widgets[i], widgets[j]))
+				{
+					widgets[j]->dirty = true;
+					grew = true;
+				}
+			}
+		}
+	}
+
+	// Erase everything first, then paint from the bottom up
+	if (erase)
+	{
+		LCD.SetFontColor(background);
+		for (int i = 0; i < count; i++)
+		{
+			FEHWidget *w = widgets[i];
+			if (!w->dirty)
+			{
+				continue;
+			}
+
+			// Keep the rectangle on screen so FillRectangle doesn't warn
+			int left = std::max(w->x, 0), top = std::max(w->y, 0);
+			int right = std::min(w->x + w->width, LCD.Width() - 1), bottom = std::min(w->y + w->height, LCD.Height() - 1);
+			if (right > left && bottom > top)
+			{
+				LCD.FillRectangle(left, top, right - left, bottom - top);
+			}
+		}
+	}
+
+	int painted = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (widgets[i]->dirty)
+		{
+			widgets[i]->Paint();
+			widgets[i]->dirty = false;
+			painted++;
+		}
+	}
+
+	return painted;
+}
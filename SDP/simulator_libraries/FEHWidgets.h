@@ -0,0 +1,273 @@
+#ifndef FEHWIDGETS_H
+#define FEHWIDGETS_H
+
+#include "FEHLCD.h"
+#include "FEHImages.h"
+
+/// @brief Base class for anything placed in a FEHWidgetTree
+/// @note Widgets are retained: they remember what they show and only repaint when that changes.
+/// Subclasses call Invalidate() whenever their appearance changes and draw themselves in Paint().
+class FEHWidget
+{
+	public:
+		/// @param x X coordinate of upper left corner
+		/// @param y Y coordinate of upper left corner
+		/// @param width Width in pixels
+		/// @param height Height in pixels
+		FEHWidget(int x, int y, int width, int height);
+
+		virtual ~FEHWidget() {}
+
+		/// @brief Draw the whole widget; the tree has already filled its rectangle with the background color
+		/// and repainted anything below it
+		virtual void Paint() = 0;
+
+		/// @brief Whether the widget responds to touch and should be in the tree's hit-test list
+		virtual bool Interactive() { return false; }
+
+		/// @brief Called by the tree while a touch that started on this widget goes on
+		/// @param inside True while the touch is still over the widget
+		virtual void Press(bool /*inside*/) {}
+
+		/// @brief Called by the tree when a touch that started on this widget ends
+		/// @param inside True if the touch ended over the widget, i.e. it was clicked
+		virtual void Release(bool /*inside*/) {}
+
+		/// @brief Ask for the widget to be repainted on the next FEHWidgetTree::Draw()
+		void Invalidate() { dirty = true; }
+
+		/// @brief Check if the widget is waiting to be repainted
+		bool Dirty() { return dirty; }
+
+		/// @name Bounds
+		///@{
+		int X() { return x; }
+		int Y() { return y; }
+		int Width() { return width; }
+		int Height() { return height; }
+		///@}
+
+	protected:
+		int x, y, width, height;
+
+	private:
+		friend class FEHWidgetTree;
+		bool dirty;
+};
+
+/// @brief Line of text
+class FEHLabel : public FEHWidget
+{
+	public:
+		/// @param x X coordinate of upper left corner of the text
+		/// @param y Y coordinate of upper left corner of the text
+		/// @param text Text to show, copied
+		/// @param color Color of the text
+		/// @param maxLength Longest text the label will ever show, which sets the area it erases when repainting. Defaults to the length of text
+		FEHLabel(int x, int y, const char *text, unsigned int color, int maxLength = 0);
+
+		~FEHLabel();
+
+		/// @brief Change the text; only repaints if it differs from the current text
+		void SetText(const char *text);
+
+		/// @brief Change the text to a number; only repaints if it differs from the current text
+		void SetText(int value);
+
+		/// @brief Change the text color
+		void SetColor(unsigned int color);
+
+		void Paint();
+
+	private:
+		FEHLabel(const FEHLabel &);
+		FEHLabel &operator=(const FEHLabel &);
+
+		char *text;
+		int maxLength;
+		unsigned int color;
+};
+
+/// @brief Image that does not respond to touch
+/// @note Nothing is drawn while the image is NULL
+class FEHPicture : public FEHWidget
+{
+	public:
+		/// @param x X coordinate of upper left corner
+		/// @param y Y coordinate of upper left corner
+		/// @param image Opened image to show, or NULL to set it later; the pointer must stay valid while the widget is in a tree
+		FEHPicture(int x, int y, FEHImage *image = NULL);
+
+		/// @brief Change the image, e.g. once a scene has loaded it; the widget takes the new image's size
+		void SetImage(FEHImage *image);
+
+		void Paint();
+
+	private:
+		FEHImage *image;
+};
+
+/// @brief Rectangle with a centered label that can be clicked, drawn like FEHIcon::Icon
+class FEHButton : public FEHWidget
+{
+	public:
+		/// @param x X coordinate of upper left corner
+		/// @param y Y coordinate of upper left corner
+		/// @param width Width in pixels
+		/// @param height Height in pixels
+		/// @param label Text shown in the middle, copied (up to 19 characters)
+		/// @param color Color of the outline
+		/// @param textColor Color of the label
+		FEHButton(int x, int y, int width, int height, const char *label, unsigned int color, unsigned int textColor);
+
+		/// @brief Check if the button was clicked since the last call
+		bool Clicked();
+
+		/// @brief Change the label; only repaints if it differs from the current one
+		void SetLabel(const char *label);
+
+		/// @name Toggling
+		/// @brief A toggle button flips between selected and not selected on every click, like FEHIcon::Icon::Pressed() in mode 0
+		///@{
+		void SetToggle(bool toggle) { this->toggle = toggle; }
+		bool Selected() { return selected; }
+		void SetSelected(bool selected);
+		///@}
+
+		bool Interactive() { return true; }
+		void Press(bool inside);
+		void Release(bool inside);
+		void Paint();
+
+	private:
+		char label[20];
+		unsigned int color;
+		unsigned int textColor;
+		bool pressed;
+		bool clicked;
+		bool toggle;
+		bool selected;
+};
+
+/// @brief Button drawn with one image normally and another while held down
+/// @note Nothing is drawn while the images are NULL
+class FEHImageButton : public FEHWidget
+{
+	public:
+		/// @param x X coordinate of upper left corner
+		/// @param y Y coordinate of upper left corner
+		/// @param width Width of the clickable area in pixels
+		/// @param height Height of the clickable area in pixels
+		/// @param image Image drawn normally; must stay valid while the widget is in a tree
+		/// @param pressedImage Image drawn while the button is held down; must stay valid while the widget is in a tree
+		FEHImageButton(int x, int y, int width, int height, FEHImage *image = NULL, FEHImage *pressedImage = NULL);
+
+		/// @brief Change both images, e.g. once a scene has loaded them
+		void SetImages(FEHImage *image, FEHImage *pressedImage);
+
+		/// @brief Check if the button was clicked since the last call
+		bool Clicked();
+
+		bool Interactive() { return true; }
+		void Press(bool inside);
+		void Release(bool inside);
+		void Paint();
+
+	private:
+		FEHImage *image;
+		FEHImage *pressedImage;
+		bool pressed;
+		bool clicked;
+};
+
+/// @brief Rows and columns of FEHButtons filling part of the screen, the retained version of FEHIcon::DrawIconArray()
+class FEHIconGrid
+{
+	public:
+		/// @param rows Number of rows
+		/// @param cols Number of columns
+		/// @param top Margin from the top of the screen
+		/// @param bot Margin from the bottom of the screen
+		/// @param left Margin from the left of the screen
+		/// @param right Margin from the right of the screen
+		/// @param labels Label of each icon, from the top left across each row to the bottom right
+		/// @param color Color of the outlines
+		/// @param textColor Color of the labels
+		FEHIconGrid(int rows, int cols, int top, int bot, int left, int right, const char labels[][20], unsigned int color, unsigned int textColor);
+
+		~FEHIconGrid();
+
+		/// @brief Index of an icon that was clicked since the last call, or -1
+		int Clicked();
+
+		/// @brief Icon at an index, counted from the top left across each row
+		FEHButton &Icon(int index) { return *icons[index]; }
+
+		/// @brief Number of icons
+		int Count() { return count; }
+
+	private:
+		friend class FEHWidgetTree;
+		FEHIconGrid(const FEHIconGrid &);
+		FEHIconGrid &operator=(const FEHIconGrid &);
+
+		FEHButton **icons;
+		int count;
+};
+
+/// @brief Flat set of widgets that handles touch and repaints only what changed
+/// @note Call Update() once per frame to hand touch input to the widgets, then Draw() to repaint the dirty ones.
+/// When nothing changed Draw() does not touch the screen, so an idle screen costs nothing to redraw.
+class FEHWidgetTree
+{
+	public:
+		/// @param background Color behind every widget, used to erase them before repainting
+		/// @param capacity Maximum number of widgets
+		FEHWidgetTree(unsigned int background, int capacity = 32);
+
+		~FEHWidgetTree();
+
+		/// @brief Add a widget; the tree does not own it and it must stay alive while in the tree
+		/// @note Widgets added later are on top: they are painted last and get touches first
+		void Add(FEHWidget *widget);
+
+		/// @brief Add every icon of a grid
+		void Add(FEHIconGrid *grid);
+
+		/// @brief Clear the screen to the background and repaint every widget on the next Draw()
+		/// @note Call when the screen was drawn over by something else, e.g. when a scene is entered.
+		/// A touch that is already going on is ignored until it ends, so the click that opened a screen can't also click on it
+		void Invalidate();
+
+		/// @brief Pass the touch events queued by the last LCD.Update() on to the widgets
+		/// @note Reads them with LCD.PollEvent(), so they are gone for other readers
+		void Update();
+
+		/// @brief Repaint the widgets that changed
+		/// @return Number of widgets repainted
+		int Draw();
+
+	private:
+		FEHWidgetTree(const FEHWidgetTree &);
+		FEHWidgetTree &operator=(const FEHWidgetTree &);
+
+		/// @brief Index of the topmost interactive widget under a point, or -1
+		int HitTest(float x, float y);
+
+		unsigned int background;
+		bool clearScreen;
+
+		FEHWidget **widgets;
+		int count;
+		int capacity;
+
+		// Hit-test list: rectangles of the interactive widgets, and which widget each belongs to
+		int *hitLeft, *hitTop, *hitRight, *hitBottom;
+		int *hitWidget;
+		int hitCount;
+
+		// Widget the current touch started on, or -1
+		int active;
+};
+
+#endif // FEHWIDGETS_H
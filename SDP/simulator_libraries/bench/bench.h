@@ -0,0 +1,190 @@
+/// @file bench.h
+/// @brief Minimal timing harness shared by the benchmarks in this directory
+/// @note Each benchmark is its own program; build and run them all with `make bench`.
+/// Every result is also written as JSON to the file named by BENCH_JSON when it is set (make bench
+/// writes bench/<program>.json). On Linux, setting BENCH_CPU pins the main thread to that CPU so runs
+/// do not move between cores while timing (make bench sets it to 0); threads it starts inherit the pin
+/// until BenchSession::Unpin().
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+/// @brief One reported result, kept for the JSON file
+struct BenchResult
+{
+	std::string name;
+	long n;
+	double seconds;
+	std::string iteration;
+	double pixels;
+};
+
+/// @brief Every result reported so far in this program
+inline std::vector<BenchResult> &benchResults()
+{
+	static std::vector<BenchResult> results;
+	return results;
+}
+
+/// @brief Pins the main thread to BENCH_CPU as the program starts and writes BENCH_JSON as it exits
+struct BenchSession
+{
+	/// @brief CPU the main thread is pinned to, or -1
+	int cpu;
+
+#ifdef __linux__
+	cpu_set_t original;
+#endif
+
+	BenchSession() : cpu(-1)
+	{
+		// Made first so it is destroyed after the destructor below has written it out
+		benchResults();
+#ifdef __linux__
+		const char *env = getenv("BENCH_CPU");
+		if (!env || !*env || sched_getaffinity(0, sizeof(original), &original) != 0)
+		{
+			return;
+		}
+		cpu = atoi(env);
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		// Only the calling thread, but every thread it starts from now on inherits this
+		if (cpu < 0 || sched_setaffinity(0, sizeof(set), &set) != 0)
+		{
+			printf("could not pin to CPU %d, times may vary more\n", cpu);
+			cpu = -1;
+		}
+#endif
+	}
+
+	/// @brief Give the main thread back every CPU it started with, for benchmarks whose threads must spread out
+	void Unpin()
+	{
+#ifdef __linux__
+		if (cpu >= 0)
+		{
+			sched_setaffinity(0, sizeof(original), &original);
+			cpu = -1;
+		}
+#endif
+	}
+
+	~BenchSession()
+	{
+		const char *path = getenv("BENCH_JSON");
+		if (!path)
+		{
+			return;
+		}
+		FILE *file = fopen(path, "w");
+		if (!file)
+		{
+			printf("could not write %s\n", path);
+			return;
+		}
+		fprintf(file, "{\"cpu\": %d, \"results\": [", cpu);
+		const std::vector<BenchResult> &results = benchResults();
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const BenchResult &r = results[i];
+			fprintf(file, "%s\n  {\"name\": \"", i ? "," : "");
+			for (size_t c = 0; c < r.name.size(); c++)
+			{
+				if (r.name[c] == '"' || r.name[c] == '\\')
+				{
+					fputc('\\', file);
+				}
+				fputc(r.name[c], file);
+			}
+			fprintf(file, "\", \"n\": %ld, \"ns_per_op\": %.3f, \"per\": \"%s\"", r.n, r.seconds * 1e9, r.iteration.c_str());
+			if (r.pixels > 0)
+			{
+				fprintf(file, ", \"pixels_per_sec\": %.0f", r.pixels / r.seconds);
+			}
+			fprintf(file, "}");
+		}
+		fprintf(file, "\n]}\n");
+		fclose(file);
+	}
+};
+
+// Each benchmark is a single translation unit, so this is one session per program
+static BenchSession benchSession;
+
+/// @brief Current time in seconds from a monotonic clock
+inline double benchNow()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief Time a piece of work several times and keep the median
+/// @param work Callable to time; called once untimed first to warm caches
+/// @param runs Number of timed calls
+/// @return Median duration of one call, in seconds
+template <class Work>
+double benchMedian(Work work, int runs)
+{
+	std::vector<double> times(runs);
+	work();
+	for (int i = 0; i < runs; i++)
+	{
+		double start = benchNow();
+		work();
+		times[i] = benchNow() - start;
+	}
+	std::sort(times.begin(), times.end());
+	return times[runs / 2];
+}
+
+/// @brief Print one result line: the time per iteration, and the pixel rate for work that covers pixels
+/// @param name Name of the measured case
+/// @param n Problem size of the case
+/// @param seconds Measured time per iteration
+/// @param iteration Unit the time is given per, e.g. "frame"
+/// @param pixels Pixels written (or decoded) by one iteration, or 0 to leave the rate out
+inline void benchReport(const char *name, long n, double seconds, const char *iteration, double pixels = 0)
+{
+	char unit[32];
+	snprintf(unit, sizeof(unit), "us/%s", iteration);
+	if (pixels > 0)
+	{
+		printf("%-44s n=%-8ld %12.3f %-9s %10.2f Mpixel/s\n", name, n, seconds * 1e6, unit, pixels / seconds / 1e6);
+	}
+	else
+	{
+		printf("%-44s n=%-8ld %12.3f %s\n", name, n, seconds * 1e6, unit);
+	}
+	BenchResult result = {name, n, seconds, iteration, pixels};
+	benchResults().push_back(result);
+}
+
+/// @brief Print one result line for a call that covers a number of pixels
+/// @param name Name of the measured case
+/// @param pixels Pixels written (or decoded) by one call, also given as its problem size
+/// @param seconds Measured time per call
+inline void benchReportPixels(const char *name, long pixels, double seconds)
+{
+	benchReport(name, pixels, seconds, "op", (double)pixels);
+}
+
+/// @brief Keep the compiler from optimizing away a result
+template <class T>
+inline void benchKeep(const T &value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif // BENCH_H
@@ -0,0 +1,110 @@
+/// @file broadphase.cpp
+/// @brief Per-frame cost of FEHBroadphase against checking every entity, as the entity count grows
+/// @note Entities are spread at a fixed density over a world that scrolls left and wraps around,
+/// like obstacles in the game, so the number of true overlaps per query stays about the same at every size
+
+#include "bench.h"
+#include "../FEHBroadphase.h"
+
+#include <stdlib.h>
+
+struct World
+{
+	int n;
+	float width;
+	std::vector<FEHHitbox> boxes;
+	std::vector<float> vx;
+
+	World(int count) : n(count), width(count * 24.0f), boxes(count), vx(count)
+	{
+		srand(1);
+		for (int i = 0; i < n; i++)
+		{
+			float x = width * rand() / RAND_MAX, y = 200.0f * rand() / RAND_MAX;
+			float w = 10 + rand() % 50, h = 10 + rand() % 50;
+			FEHHitbox b = {x, y, x + w, y + h};
+			boxes[i] = b;
+			vx[i] = -2.0f - (rand() % 100) / 100.0f;
+		}
+	}
+
+	// Scroll every box left, wrapping it around to the right edge once it leaves the world
+	void Step()
+	{
+		for (int i = 0; i < n; i++)
+		{
+			FEHHitbox &b = boxes[i];
+			b.left += vx[i];
+			b.right += vx[i];
+			if (b.right < 0)
+			{
+				b.left += width;
+				b.right += width;
+			}
+		}
+	}
+};
+
+int main()
+{
+	const int sizes[] = {16, 64, 256, 1024, 4096, 16384};
+	const int frames = 200;
+	FEHHitbox player = {84, 125, 108, 175};
+
+	static int hits[1 << 16], first[1 << 16], second[1 << 16];
+
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+	{
+		int n = sizes[s];
+		World world(n);
+		FEHBroadphase broadphase(n);
+
+		// Refill and re-sort every box, as the game does once per frame
+		double update = benchMedian([&]() {
+			for (int f = 0; f < frames; f++)
+			{
+				world.Step();
+				broadphase.Clear();
+				for (int i = 0; i < n; i++)
+				{
+					broadphase.Set(i, world.boxes[i]);
+				}
+				broadphase.Update();
+			}
+		}, 5) / frames;
+
+		// One box against everything: the player's collision check
+		double query = benchMedian([&]() {
+			for (int f = 0; f < frames; f++)
+			{
+				benchKeep(broadphase.Query(player, hits, 1 << 16));
+			}
+		}, 5) / frames;
+
+		double linear = benchMedian([&]() {
+			for (int f = 0; f < frames; f++)
+			{
+				int found = 0;
+				for (int i = 0; i < n; i++)
+				{
+					const FEHHitbox &b = world.boxes[i];
+					found += (b.left < player.right) & (b.right > player.left) & (b.top < player.bottom) & (b.bottom > player.top);
+				}
+				benchKeep(found);
+			}
+		}, 5) / frames;
+
+		// Everything against everything
+		double pairs = benchMedian([&]() {
+			benchKeep(broadphase.Pairs(first, second, 1 << 16));
+		}, 5);
+
+		benchReport("broadphase/update", n, update, "frame");
+		benchReport("broadphase/query", n, query, "query");
+		benchReport("linear/query", n, linear, "query");
+		benchReport("broadphase/pairs", n, pairs, "frame");
+		benchReport("broadphase/pairs per entity", n, pairs / n, "entity");
+	}
+
+	return 0;
+}
@@ -0,0 +1,150 @@
+/// @file drawlist.cpp
+/// @brief Frame time of FEHDrawList from 1 thread up to one per core, against drawing immediately
+/// @note The frame is built like the game's: a background, full-screen translucent parallax layers,
+/// sprites at fractional positions and a strip of text, at the LCD size and at larger screens.
+/// Pass a thread count to go past the number of cores.
+
+#include "bench.h"
+#include "../FEHDrawList.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+struct Scene
+{
+	int w, h;
+	Tigr *background, *layer, *sprite;
+
+	Scene(int width, int height) : w(width), h(height)
+	{
+		srand(1);
+		background = tigrBitmap(w, h);
+		layer = tigrBitmap(w, h);
+		sprite = tigrBitmap(48, 48);
+		for (int i = 0; i < w * h; i++)
+		{
+			background->pix[i] = tigrRGB(rand(), rand(), rand());
+			// Mostly see-through, like hills and clouds over the sky
+			layer->pix[i] = tigrRGBA(rand(), rand(), rand(), (i / w) > h / 2 ? 255 : rand() % 64);
+		}
+		for (int i = 0; i < 48 * 48; i++)
+		{
+			sprite->pix[i] = tigrRGBA(rand(), rand(), rand(), rand() % 2 ? 255 : 0);
+		}
+	}
+
+	~Scene()
+	{
+		tigrFree(background);
+		tigrFree(layer);
+		tigrFree(sprite);
+	}
+
+	// Record one frame; scroll moves the layers like the game does
+	void Record(FEHDrawList &list, float scroll)
+	{
+		list.Clear(tigrRGB(0, 0, 0));
+		list.BlitAlpha(background, 0, 0, 0, 0, w, h, 1.0f);
+		for (int l = 0; l < 3; l++)
+		{
+			int x = -((int)(scroll * (l + 1)) % w);
+			list.BlitAlpha(layer, x, 0, 0, 0, w, h, 1.0f);
+			list.BlitAlpha(layer, x + w, 0, 0, 0, w, h, 1.0f);
+		}
+		for (int s = 0; s < 24; s++)
+		{
+			list.BlitSubpixel(sprite, (s * 97 + scroll * 1.37f) - (int)((s * 97 + scroll * 1.37f) / w) * w, (s * 53) % (h - 48), 0, 0, 48, 48, 1.0f);
+		}
+		for (int c = 0; c < 40; c++)
+		{
+			list.Fill(4 + c * 8, 4, 6, 10, tigrRGB(255, 255, 255));
+			list.Line(4 + c * 8, 16, 10 + c * 8, 16, tigrRGB(255, 0, 0));
+		}
+	}
+
+	// The same frame drawn straight into the bitmap
+	void Draw(Tigr *dst, float scroll)
+	{
+		tigrClear(dst, tigrRGB(0, 0, 0));
+		tigrBlitAlpha(dst, background, 0, 0, 0, 0, w, h, 1.0f);
+		for (int l = 0; l < 3; l++)
+		{
+			int x = -((int)(scroll * (l + 1)) % w);
+			tigrBlitAlpha(dst, layer, x, 0, 0, 0, w, h, 1.0f);
+			tigrBlitAlpha(dst, layer, x + w, 0, 0, 0, w, h, 1.0f);
+		}
+		for (int s = 0; s < 24; s++)
+		{
+			tigrBlitSubpixel(dst, sprite, (s * 97 + scroll * 1.37f) - (int)((s * 97 + scroll * 1.37f) / w) * w, (s * 53) % (h - 48), 0, 0, 48, 48, 1.0f);
+		}
+		for (int c = 0; c < 40; c++)
+		{
+			tigrFill(dst, 4 + c * 8, 4, 6, 10, tigrRGB(255, 255, 255));
+			tigrLine(dst, 4 + c * 8, 16, 10 + c * 8, 16, tigrRGB(255, 0, 0));
+		}
+	}
+};
+
+int main(int argc, char **argv)
+{
+	const int sizes[][2] = {{320, 240}, {1280, 720}, {1920, 1080}};
+	const int frames = 20;
+
+	// The draw threads would inherit a BENCH_CPU pin and all share one core
+	benchSession.Unpin();
+
+	int maxThreads = argc > 1 ? atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+	if (maxThreads < 1)
+	{
+		maxThreads = 1;
+	}
+
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+	{
+		int w = sizes[s][0], h = sizes[s][1];
+		char name[64];
+		Scene scene(w, h);
+		Tigr *expected = tigrBitmap(w, h);
+		Tigr *screen = tigrBitmap(w, h);
+
+		double immediate = benchMedian([&]() {
+			for (int f = 0; f < frames; f++)
+			{
+				scene.Draw(expected, f * 3.1f);
+			}
+		}, 5) / frames;
+		snprintf(name, sizeof(name), "immediate/%dx%d", w, h);
+		benchReport(name, w * h, immediate, "frame");
+
+		FEHDrawList list;
+		// Doubling, then one last step to exactly maxThreads
+		for (int t = 1; t <= maxThreads; t = (t < maxThreads && t * 2 > maxThreads) ? maxThreads : t * 2)
+		{
+			list.SetThreads(t);
+			double recorded = benchMedian([&]() {
+				for (int f = 0; f < frames; f++)
+				{
+					scene.Record(list, f * 3.1f);
+					list.Execute(screen);
+				}
+			}, 5) / frames;
+
+			// The last frame of each run must match drawing immediately
+			if (memcmp(screen->pix, expected->pix, w * h * sizeof(TPixel)) != 0)
+			{
+				printf("drawlist/%dx%d with %d threads does not match immediate drawing\n", w, h, t);
+				return 1;
+			}
+
+			snprintf(name, sizeof(name), "drawlist/%dx%d threads=%d", w, h, t);
+			benchReport(name, w * h, recorded, "frame");
+			printf("%-32s speedup %.2fx\n", "", immediate / recorded);
+		}
+
+		tigrFree(expected);
+		tigrFree(screen);
+	}
+
+	return 0;
+}
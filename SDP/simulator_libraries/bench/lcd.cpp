@@ -0,0 +1,233 @@
+/// @file lcd.cpp
+/// @brief Cost of what a frame of the game is made of: decoding its assets, the tigr calls under FEHLCD and FEHImage,
+/// text, icons, and one whole frame of the running screen of primary.cpp
+/// @note Links the real libraries, so it runs headless (make bench sets FEH_HEADLESS) from simulator_libraries/,
+/// where the game's assets are found in the parent directory.
+
+#include "bench.h"
+#include "../FEHLCD.h"
+#include "../FEHImages.h"
+
+#include <dirent.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Every .png the game could load, found under the parent directory (the libraries' own folder is left out)
+static void findAssets(const std::string &dir, std::vector<std::string> *found)
+{
+	DIR *d = opendir(dir.c_str());
+	if (!d)
+	{
+		return;
+	}
+	struct dirent *entry;
+	while ((entry = readdir(d)) != NULL)
+	{
+		std::string name = entry->d_name;
+		if (name[0] == '.' || name == "simulator_libraries")
+		{
+			continue;
+		}
+		std::string path = dir + "/" + name;
+		if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0)
+		{
+			found->push_back(path);
+		}
+		else
+		{
+			findAssets(path, found);
+		}
+	}
+	closedir(d);
+}
+
+// Decoding alone: the file is read into memory before timing
+static void decodeAssets()
+{
+	std::vector<std::string> assets;
+	findAssets("..", &assets);
+	std::sort(assets.begin(), assets.end());
+
+	for (size_t i = 0; i < assets.size(); i++)
+	{
+		FILE *file = fopen(assets[i].c_str(), "rb");
+		if (!file)
+		{
+			continue;
+		}
+		fseek(file, 0, SEEK_END);
+		long length = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		std::vector<char> data(length);
+		length = (long)fread(data.data(), 1, length, file);
+		fclose(file);
+
+		Tigr *image = tigrLoadImageMem(data.data(), (int)length);
+		if (!image)
+		{
+			continue;
+		}
+		long pixels = (long)image->w * image->h;
+		tigrFree(image);
+
+		double seconds = benchMedian([&]() { tigrFree(tigrLoadImageMem(data.data(), (int)length)); }, 5);
+		std::string name = "decode " + assets[i].substr(3);
+		benchReportPixels(name.c_str(), pixels, seconds);
+	}
+}
+
+// The tigr calls FEHLCD and FEHImage come down to, on a screen the size of LCD's
+static void primitives()
+{
+	const int w = LCD.Width(), h = LCD.Height();
+	const int runs = 15;
+	Tigr *screen = tigrBitmap(w, h);
+	char name[64];
+
+	benchReportPixels("tigrClear", (long)w * h, benchMedian([&]() { tigrClear(screen, tigrRGB(1, 2, 3)); }, runs));
+	benchReportPixels("tigrFill full", (long)w * h, benchMedian([&]() { tigrFill(screen, 0, 0, w, h, tigrRGB(4, 5, 6)); }, runs));
+
+	// LCD.Write() fills 2x2 squares, one per lit font pixel
+	benchReportPixels("tigrFill 2x2 x1000", 4000, benchMedian([&]() {
+		for (int i = 0; i < 1000; i++)
+		{
+			tigrFill(screen, (i * 7) % (w - 2), (i * 13) % (h - 2), 2, 2, tigrRGB(7, 8, 9));
+		}
+	}, runs));
+
+	// A fan of 100 lines about 100 pixels long in every direction
+	benchReportPixels("tigrLine x100", 100 * 100, benchMedian([&]() {
+		for (int i = 0; i < 100; i++)
+		{
+			int dx = (i % 25) * 8 - 100, dy = (i / 25) * 50 - 100;
+			tigrLine(screen, w / 2, h / 2, w / 2 + (dx > 0 ? 100 : -100) * (i & 1), h / 2 + dy, tigrRGB(255, 255, 255));
+			tigrLine(screen, w / 2, h / 2, w / 2 + dx, h / 2 + (dy > 0 ? 100 : -100) * (1 - (i & 1)), tigrRGB(255, 255, 255));
+		}
+	}, runs));
+
+	// Sprites of each size, mostly see-through like the game's, at each strength of tint alpha
+	const int sizes[] = {16, 32, 64, 128};
+	const int alphas[] = {255, 128, 32};
+	srand(1);
+	for (int s = 0; s < 4; s++)
+	{
+		int size = sizes[s];
+		Tigr *sprite = tigrBitmap(size, size);
+		for (int i = 0; i < size * size; i++)
+		{
+			sprite->pix[i] = tigrRGBA(rand(), rand(), rand(), rand() % 3 ? 0 : 255);
+		}
+		for (int a = 0; a < 3; a++)
+		{
+			TPixel tint = tigrRGBA(255, 255, 255, alphas[a]);
+			snprintf(name, sizeof(name), "tigrBlitTint %dx%d alpha %d x16", size, size, alphas[a]);
+			benchReportPixels(name, 16L * size * size, benchMedian([&]() {
+				for (int i = 0; i < 16; i++)
+				{
+					tigrBlitTint(screen, sprite, (i * 37) % (w - size), (i * 23) % (h - size), 0, 0, size, size, tint);
+				}
+			}, runs));
+		}
+		tigrFree(sprite);
+	}
+
+	benchKeep(screen->pix[0]);
+	tigrFree(screen);
+}
+
+// Drawing through LCD itself, finished with the Update() a game's frame ends with
+static void lcd()
+{
+	const int w = LCD.Width(), h = LCD.Height();
+	const int runs = 15;
+
+	// A line of text nearly as wide as the screen, counted by the cells it covers
+	const char *line = "The quick brown fox jumps!";
+	int cells = (int)strlen(line);
+	benchReportPixels("LCD.WriteAt 26 chars", (long)cells * 12 * 17, benchMedian([&]() {
+		LCD.WriteAt(line, 0, 100);
+		LCD.Update();
+	}, runs));
+
+	// A full screen of text, as the info and credits screens are
+	benchReportPixels("LCD.WriteLine page", (long)w * h, benchMedian([&]() {
+		LCD.Clear(BLACK);
+		for (int row = 0; row < h / 17; row++)
+		{
+			LCD.WriteLine(line);
+		}
+		LCD.Update();
+	}, runs));
+
+	FEHIcon::Icon icons[12];
+	char labels[12][20] = {"1", "2", "3", "4", "5", "6", "7", "8", "9", "0", "OK", "Back"};
+	benchReportPixels("FEHIcon::DrawIconArray 3x4", (long)w * h, benchMedian([&]() {
+		LCD.Clear(BLACK);
+		FEHIcon::DrawIconArray(icons, 3, 4, 10, 10, 10, 10, labels, BLUE, WHITE);
+		LCD.Update();
+	}, runs));
+}
+
+// One frame of GameScene::Draw() in primary.cpp: the same images drawn in the same order and way,
+// with a typical number of objects and obstacles on screen
+static void runningScene()
+{
+	const int w = LCD.Width(), h = LCD.Height();
+	FEHImage background("../Backgrounds/BlueBackground-1.png");
+	FEHImage ground("../Ground/Ground-1.png");
+	FEHImage clouds("../Backgrounds/BackgroundWClouds.png");
+	FEHImage player("../character/sprite_00.png");
+	FEHImage things[6] = {
+		FEHImage("../objects/Heart.png"), FEHImage("../objects/Coffee.png"), FEHImage("../obstacles/Bill.png"),
+		FEHImage("../obstacles/Clock.png"), FEHImage("../obstacles/books.png"), FEHImage("../obstacles/Email.png"),
+	};
+	float scroll = 0;
+
+	benchReportPixels("running scene frame", (long)w * h, benchMedian([&]() {
+		scroll -= 1.25f;
+		if (scroll < -300)
+		{
+			scroll += 300;
+		}
+
+		background.Draw(0, 0);
+		LCD.SetFontColor(WHITESMOKE);
+		LCD.WriteAt(123, 280, 10);
+		for (int i = 0; i < 3; i++)
+		{
+			ground.DrawSubpixel(scroll + i * 300, 0);
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			clouds.DrawSubpixel(scroll / 4 + i * 300, 0);
+		}
+		player.Draw(0, 85);
+
+		// The jump bar
+		LCD.SetFontColor(WHITE);
+		LCD.FillRectangle(15, 205, 75, 20);
+		LCD.SetFontColor(RED);
+		LCD.FillRectangle(80, 205, 10, 20);
+
+		for (int i = 0; i < 6; i++)
+		{
+			things[i].Draw(60 + i * 40 + (int)scroll % 40, 120 + (i % 3) * 20);
+		}
+		LCD.Update();
+	}, 31));
+}
+
+int main()
+{
+	if (!LCD.IsHeadless())
+	{
+		printf("Run with FEH_HEADLESS set, as make bench does\n");
+		return 1;
+	}
+	decodeAssets();
+	primitives();
+	lcd();
+	runningScene();
+	return 0;
+}
@@ -0,0 +1,110 @@
+/// @file png.cpp
+/// @brief Cost and size of a screenshot with tigrEncodeImage at each level, checked by decoding it again
+/// @note The frame is built like the game's: a gradient sky, flat hills, sprites and text, at the LCD
+/// size and at larger screens. Pass a path to also encode that PNG instead of the made-up frame.
+
+#include "bench.h"
+#include "../tigr.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static Tigr *makeFrame(int w, int h)
+{
+	Tigr *frame = tigrBitmap(w, h);
+	for (int y = 0; y < h; y++)
+	{
+		tigrLine(frame, 0, y, w, y, tigrRGB(40 + y * 100 / h, 120 + y * 80 / h, 220));
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		tigrFill(frame, i * w / 12, h - h / 4 - (i * 37) % (h / 6), w / 12, h, tigrRGB(60, 140 + i * 5, 50));
+	}
+	srand(1);
+	for (int s = 0; s < 20; s++)
+	{
+		int x = rand() % (w - 32), y = rand() % (h - 32);
+		for (int p = 0; p < 32 * 32; p++)
+		{
+			if (rand() % 3)
+			{
+				tigrPlot(frame, x + p % 32, y + p / 32, tigrRGB(rand(), rand(), rand()));
+			}
+		}
+	}
+	tigrPrint(frame, tfont, 4, 4, tigrRGB(255, 255, 255), "Score: 12345  Lives: 3");
+	return frame;
+}
+
+static bool check(const char *name, Tigr *frame, void *data, int length)
+{
+	Tigr *decoded = tigrLoadImageMem(data, length);
+	bool ok = decoded && decoded->w == frame->w && decoded->h == frame->h &&
+			  memcmp(decoded->pix, frame->pix, frame->w * frame->h * sizeof(TPixel)) == 0;
+	if (!ok)
+	{
+		printf("%s does not decode back to the same pixels\n", name);
+	}
+	if (decoded)
+	{
+		tigrFree(decoded);
+	}
+	return ok;
+}
+
+static bool run(const char *label, Tigr *frame)
+{
+	const int runs = 9;
+	for (int level = 0; level <= 1; level++)
+	{
+		char name[64];
+		int length = 0;
+		void *data = NULL;
+
+		double seconds = benchMedian([&]() {
+			free(data);
+			data = tigrEncodeImage(frame, level, &length);
+		}, runs);
+
+		snprintf(name, sizeof(name), "png level %d/%s", level, label);
+		if (!data || !check(name, frame, data, length))
+		{
+			return false;
+		}
+		benchReport(name, (long)frame->w * frame->h, seconds, "frame");
+		printf("%-32s %12d bytes\n", "", length);
+		free(data);
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1)
+	{
+		Tigr *image = tigrLoadImage(argv[1]);
+		if (!image)
+		{
+			printf("could not load %s\n", argv[1]);
+			return 1;
+		}
+		bool ok = run(argv[1], image);
+		tigrFree(image);
+		return ok ? 0 : 1;
+	}
+
+	const int sizes[][2] = {{320, 240}, {1280, 720}, {1920, 1080}};
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+	{
+		char label[32];
+		snprintf(label, sizeof(label), "%dx%d", sizes[s][0], sizes[s][1]);
+		Tigr *frame = makeFrame(sizes[s][0], sizes[s][1]);
+		bool ok = run(label, frame);
+		tigrFree(frame);
+		if (!ok)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,106 @@
+/// @file raster.cpp
+/// @brief Cost of the rasterization FEHLCD and FEHImage do, at each screen size FEHLCD::SetResolution() is meant for
+/// @note Whole-screen operations are reported as a pixel rate as well, so a size where the rate
+/// drops (a cache or memory bandwidth cliff) stands out from plain growth in area.
+
+#include "bench.h"
+#include "../FEHLCD.h"
+
+#include <stdlib.h>
+
+static void report(const char *name, int w, int h, double seconds)
+{
+	char label[64];
+	snprintf(label, sizeof(label), "%s/%dx%d", name, w, h);
+	benchReport(label, (long)w * h, seconds, "frame", (double)w * h);
+}
+
+int main()
+{
+	const int sizes[][2] = {{320, 240}, {640, 480}, {1280, 720}, {1920, 1080}};
+	const int runs = 9;
+
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+	{
+		int w = sizes[s][0], h = sizes[s][1];
+		Tigr *screen = tigrBitmap(w, h);
+		Tigr *image = tigrBitmap(w, h);
+		Tigr *ground = tigrBitmap(w, h);
+		Tigr *sprite = tigrBitmap(32, 32);
+
+		srand(1);
+		for (int i = 0; i < w * h; i++)
+		{
+			image->pix[i] = tigrRGBA(rand(), rand(), rand(), rand() % 4 ? 255 : 0);
+			ground->pix[i] = tigrRGB(rand(), rand(), rand());
+		}
+		for (int i = 0; i < 32 * 32; i++)
+		{
+			sprite->pix[i] = tigrRGBA(rand(), rand(), rand(), rand() % 2 ? 255 : 0);
+		}
+
+		// LCD.Clear()
+		report("clear", w, h, benchMedian([&]() {
+			tigrClear(screen, tigrRGB(1, 2, 3));
+		}, runs));
+
+		// LCD.FillRectangle() over the whole screen, as FEHWidgetTree does to start over
+		report("fill", w, h, benchMedian([&]() {
+			tigrFill(screen, 0, 0, w, h, tigrRGB(4, 5, 6));
+		}, runs));
+
+		// FEHImage::Draw() of a full-screen background
+		report("blit alpha", w, h, benchMedian([&]() {
+			tigrBlitAlpha(screen, image, 0, 0, 0, 0, w, h, 1.0f);
+		}, runs));
+
+		// FEHImage::DrawSubpixel() of a full-screen parallax layer
+		report("blit subpixel", w, h, benchMedian([&]() {
+			tigrBlitSubpixel(screen, image, 0.5f, 0, 0, 0, w, h, 1.0f);
+		}, runs));
+
+		// The same for an opaque ground layer, which takes the plain lerp
+		report("blit subpixel opaque", w, h, benchMedian([&]() {
+			tigrBlitSubpixel(screen, ground, 0.5f, 0, 0, 0, w, h, 1.0f);
+		}, runs));
+
+		// A screen full of LCD.Write() text: every lit font pixel is a 2x2 FillRectangle
+		report("text page", w, h, benchMedian([&]() {
+			for (int y = 3; y + CHAR_HEIGHT <= h; y += CHAR_HEIGHT)
+			{
+				for (int x = 2; x + CHAR_WIDTH <= w; x += CHAR_WIDTH)
+				{
+					for (int col = 0; col < 5; col++)
+					{
+						for (int row = 0; row < 7; row++)
+						{
+							if ((col + row + x) & 1)
+							{
+								tigrFill(screen, x + 2 + col * 2, y + row * 2, 2, 2, tigrRGB(255, 255, 255));
+							}
+						}
+					}
+				}
+			}
+		}, runs));
+
+		// Sprites cost the same at any size; listed to show what the whole-screen passes are compared against
+		double sprites = benchMedian([&]() {
+			for (int i = 0; i < 64; i++)
+			{
+				tigrBlitAlpha(screen, sprite, (i * 97) % (w - 32), (i * 53) % (h - 32), 0, 0, 32, 32, 1.0f);
+			}
+		}, runs);
+		char label[64];
+		snprintf(label, sizeof(label), "64 sprites/%dx%d", w, h);
+		benchReport(label, 64, sprites, "frame");
+
+		benchKeep(screen->pix[0]);
+		tigrFree(screen);
+		tigrFree(image);
+		tigrFree(ground);
+		tigrFree(sprite);
+	}
+
+	return 0;
+}
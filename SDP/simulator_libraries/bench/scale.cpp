@@ -0,0 +1,129 @@
+/// @file scale.cpp
+/// @brief Cost of tigrScaleNearest and tigrScaleSmooth for each factor, against plain per-pixel loops
+/// @note The source is a 320x240 frame of flat-colored shapes, like the game's sprites and text,
+/// so Scale2x/Scale3x find edges to round off. The plain loops double as a check of the results.
+
+#include "bench.h"
+#include "../tigr.h"
+
+#include <string.h>
+
+// One output pixel at a time, indexing back into the source
+static void nearestReference(Tigr *dst, Tigr *src, int factor)
+{
+	for (int y = 0; y < dst->h; y++)
+	{
+		for (int x = 0; x < dst->w; x++)
+		{
+			dst->pix[y * dst->w + x] = src->pix[(y / factor) * src->w + x / factor];
+		}
+	}
+}
+
+static bool same(TPixel a, TPixel b)
+{
+	return memcmp(&a, &b, sizeof(TPixel)) == 0;
+}
+
+// Scale2x exactly as it is usually written, one source pixel at a time
+static void scale2xReference(Tigr *dst, Tigr *src)
+{
+	int w = src->w, h = src->h;
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			TPixel p = src->pix[y * w + x];
+			TPixel a = src->pix[(y > 0 ? y - 1 : y) * w + x];
+			TPixel d = src->pix[(y < h - 1 ? y + 1 : y) * w + x];
+			TPixel c = src->pix[y * w + (x > 0 ? x - 1 : x)];
+			TPixel b = src->pix[y * w + (x < w - 1 ? x + 1 : x)];
+			TPixel *d0 = dst->pix + 2 * y * dst->w + 2 * x, *d1 = d0 + dst->w;
+
+			d0[0] = same(c, a) && !same(c, d) && !same(a, b) ? a : p;
+			d0[1] = same(a, b) && !same(a, c) && !same(b, d) ? b : p;
+			d1[0] = same(d, c) && !same(d, b) && !same(c, a) ? c : p;
+			d1[1] = same(b, d) && !same(b, a) && !same(d, c) ? d : p;
+		}
+	}
+}
+
+int main()
+{
+	const int w = 320, h = 240;
+	const int runs = 15;
+
+	Tigr *src = tigrBitmap(w, h);
+	tigrClear(src, tigrRGB(40, 120, 200));
+	for (int i = 0; i < 40; i++)
+	{
+		int cx = (i * 71) % w, cy = (i * 37) % h, r = 6 + i % 20;
+		TPixel color = tigrRGB(i * 50, 255 - i * 30, i * 90);
+		for (int y = -r; y <= r; y++)
+		{
+			for (int x = -r; x <= r; x++)
+			{
+				if (x * x + y * y <= r * r)
+				{
+					tigrPlot(src, cx + x, cy + y, color);
+				}
+			}
+		}
+		tigrLine(src, cx, cy, cx + 60, cy + 45, tigrRGB(255, 255, 255));
+	}
+
+	for (int factor = 2; factor <= 4; factor++)
+	{
+		char name[64];
+		Tigr *dst = tigrBitmap(w * factor, h * factor);
+		Tigr *expected = tigrBitmap(w * factor, h * factor);
+
+		double reference = benchMedian([&]() { nearestReference(expected, src, factor); }, runs);
+		double nearest = benchMedian([&]() { tigrScaleNearest(dst, src, factor); }, runs);
+		if (memcmp(dst->pix, expected->pix, dst->w * dst->h * sizeof(TPixel)) != 0)
+		{
+			printf("tigrScaleNearest x%d does not match the reference\n", factor);
+			return 1;
+		}
+
+		snprintf(name, sizeof(name), "nearest reference x%d", factor);
+		benchReport(name, w * h, reference, "frame");
+		snprintf(name, sizeof(name), "tigrScaleNearest x%d", factor);
+		benchReport(name, w * h, nearest, "frame");
+
+		double smooth = benchMedian([&]() { tigrScaleSmooth(dst, src, factor); }, runs);
+		snprintf(name, sizeof(name), "tigrScaleSmooth x%d", factor);
+		benchReport(name, w * h, smooth, "frame");
+
+		if (factor == 2)
+		{
+			double reference2x = benchMedian([&]() { scale2xReference(expected, src); }, runs);
+			if (memcmp(dst->pix, expected->pix, dst->w * dst->h * sizeof(TPixel)) != 0)
+			{
+				printf("tigrScaleSmooth x2 does not match the reference\n");
+				return 1;
+			}
+			benchReport("scale2x reference x2", w * h, reference2x, "frame");
+		}
+		if (factor == 4)
+		{
+			// Scale4x is Scale2x twice, whatever the scratch bitmap in between held before
+			Tigr *half = tigrBitmap(w * 2, h * 2);
+			scale2xReference(half, src);
+			scale2xReference(expected, half);
+			tigrFree(half);
+			tigrScaleSmooth(dst, src, factor);
+			if (memcmp(dst->pix, expected->pix, dst->w * dst->h * sizeof(TPixel)) != 0)
+			{
+				printf("tigrScaleSmooth x4 does not match the reference\n");
+				return 1;
+			}
+		}
+
+		tigrFree(dst);
+		tigrFree(expected);
+	}
+
+	tigrFree(src);
+	return 0;
+}
@@ -0,0 +1,127 @@
+/// @file arena.cpp
+/// @brief Tests of FEHArena: alignment, growing past a block, what Reset() keeps, and FEHDrawList recording into one
+/// @note Needs no screen, so unlike golden.cpp it doesn't link FEHLCD.
+
+#include "../FEHArena.h"
+#include "../FEHDrawList.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static void alignment()
+{
+	FEHArena arena(256);
+	const size_t aligns[] = {1, 2, 4, 8, 16, 64, 4096};
+	for (int round = 0; round < 3; round++)
+	{
+		for (size_t i = 0; i < sizeof(aligns) / sizeof(aligns[0]); i++)
+		{
+			// Odd sizes in between, so each one starts off the alignment wanted
+			arena.Allocate(3, 1);
+			char *p = (char *)arena.Allocate(24, aligns[i]);
+			check(p && ((uintptr_t)p & (aligns[i] - 1)) == 0, "alignment: pointer aligned as asked");
+			memset(p, 0xab, 24);
+		}
+		arena.Reset();
+	}
+}
+
+static void growth()
+{
+	FEHArena arena(64);
+	std::vector<int *> handed;
+	for (int i = 0; i < 100; i++)
+	{
+		int *p = (int *)arena.Allocate(sizeof(int) * 4, alignof(int));
+		check(p != NULL, "growth: allocation past the first block");
+		p[0] = p[3] = i;
+		handed.push_back(p);
+	}
+
+	// Earlier memory is never moved or reused before a reset
+	bool intact = true;
+	for (int i = 0; i < 100; i++)
+	{
+		intact = intact && handed[i][0] == i && handed[i][3] == i;
+	}
+	check(intact, "growth: earlier allocations left alone");
+
+	// Larger than a block
+	check(arena.Allocate(1000, 8) != NULL, "growth: allocation bigger than a block");
+	check(arena.Used() >= 100 * 16 + 1000, "growth: Used() counts everything handed out");
+}
+
+static void reset()
+{
+	FEHArena arena(128);
+	for (int i = 0; i < 50; i++)
+	{
+		arena.Allocate(40, 8);
+	}
+	size_t used = arena.Used(), capacity = arena.Capacity();
+	check(used >= 50 * 40 && capacity >= used, "reset: capacity covers what was used");
+
+	arena.Reset();
+	check(arena.Used() == 0, "reset: Used() back to 0");
+	check(arena.Peak() >= used, "reset: Peak() remembers the most used");
+	check(arena.Capacity() == capacity, "reset: memory kept, not given back");
+
+	// The same frame again fits in the one block Reset() merged everything into, so capacity stays put
+	char *start = (char *)arena.Allocate(40, 8);
+	for (int i = 1; i < 50; i++)
+	{
+		arena.Allocate(40, 8);
+	}
+	check(arena.Capacity() == capacity, "reset: a frame like the last one needs no more memory");
+
+	// And memory is handed out from the start again
+	arena.Reset();
+	check((char *)arena.Allocate(40, 8) == start, "reset: allocation starts over at the beginning");
+}
+
+static void drawList()
+{
+	FEHArena arena(1024);
+	Tigr *screen = tigrBitmap(64, 48), *expected = tigrBitmap(64, 48);
+	FEHDrawList list(1, &arena);
+
+	for (int frame = 0; frame < 3; frame++)
+	{
+		tigrClear(expected, tigrRGB(1, 2, 3));
+		list.Clear(tigrRGB(1, 2, 3));
+		for (int i = 0; i < 500; i++)
+		{
+			TPixel color = tigrRGB(i, frame * 40, 255 - i);
+			tigrFill(expected, i % 60, i % 44, 4, 4, color);
+			list.Fill(i % 60, i % 44, 4, 4, color);
+		}
+		list.Execute(screen);
+		check(memcmp(screen->pix, expected->pix, 64 * 48 * sizeof(TPixel)) == 0, "draw list: recorded into an arena draws the same");
+		check(arena.Used() >= 501 * sizeof(int) * 4, "draw list: calls kept in the arena");
+
+		size_t capacity = arena.Capacity();
+		arena.Reset();
+		if (frame > 0)
+		{
+			check(arena.Capacity() == capacity, "draw list: later frames need no more memory");
+		}
+	}
+
+	tigrFree(screen);
+	tigrFree(expected);
+}
+
+static const Test tests[] = {
+	{"arena_alignment", alignment},
+	{"arena_growth", growth},
+	{"arena_reset", reset},
+	{"arena_draw_list", drawList},
+};
+
+int main()
+{
+	return runTests(tests);
+}
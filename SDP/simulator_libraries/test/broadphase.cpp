@@ -0,0 +1,238 @@
+/// @file broadphase.cpp
+/// @brief Tests of FEHBroadphase: Query() and Pairs() against checking every box, edges that only touch,
+/// and registering, removing and clearing ids between updates
+/// @note Needs no screen, so unlike golden.cpp it doesn't link FEHLCD.
+
+#include "../FEHBroadphase.h"
+#include "test.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<int, int> > PairList;
+
+static bool overlaps(const FEHHitbox &a, const FEHHitbox &b)
+{
+	return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+// Ids of the registered boxes that overlap a box, checked one by one
+static std::vector<int> bruteQuery(const std::vector<FEHHitbox> &boxes, const std::vector<bool> &registered, FEHHitbox box)
+{
+	std::vector<int> ids;
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		if (registered[i] && overlaps(boxes[i], box))
+		{
+			ids.push_back(i);
+		}
+	}
+	return ids;
+}
+
+static PairList brutePairs(const std::vector<FEHHitbox> &boxes, const std::vector<bool> &registered)
+{
+	PairList pairs;
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		for (int j = i + 1; j < (int)boxes.size(); j++)
+		{
+			if (registered[i] && registered[j] && overlaps(boxes[i], boxes[j]))
+			{
+				pairs.push_back(std::make_pair(i, j));
+			}
+		}
+	}
+	return pairs;
+}
+
+static std::vector<int> query(FEHBroadphase &broadphase, FEHHitbox box)
+{
+	static int hits[1 << 12];
+	int n = broadphase.Query(box, hits, 1 << 12);
+	std::vector<int> ids(hits, hits + n);
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+static PairList pairs(FEHBroadphase &broadphase)
+{
+	static int first[1 << 14], second[1 << 14];
+	int n = broadphase.Pairs(first, second, 1 << 14);
+	PairList found;
+	for (int i = 0; i < n; i++)
+	{
+		found.push_back(std::make_pair(std::min(first[i], second[i]), std::max(first[i], second[i])));
+	}
+	std::sort(found.begin(), found.end());
+	return found;
+}
+
+// Boxes scrolling left at slightly different speeds and wrapping around, as in bench/broadphase.cpp
+static void bruteForce()
+{
+	const int n = 256;
+	const float width = n * 24.0f;
+	std::vector<FEHHitbox> boxes(n);
+	std::vector<float> vx(n);
+	std::vector<bool> registered(n, true);
+	FEHBroadphase broadphase(n);
+
+	srand(1);
+	for (int i = 0; i < n; i++)
+	{
+		float x = width * rand() / RAND_MAX, y = 200.0f * rand() / RAND_MAX;
+		float w = 10 + rand() % 50, h = 10 + rand() % 50;
+		FEHHitbox b = {x, y, x + w, y + h};
+		boxes[i] = b;
+		vx[i] = -2.0f - (rand() % 100) / 100.0f;
+	}
+
+	for (int frame = 0; frame < 300; frame++)
+	{
+		for (int i = 0; i < n; i++)
+		{
+			FEHHitbox &b = boxes[i];
+			b.left += vx[i];
+			b.right += vx[i];
+			if (b.right < 0)
+			{
+				b.left += width;
+				b.right += width;
+			}
+			broadphase.Set(i, b);
+		}
+		broadphase.Update();
+
+		FEHHitbox player = {84, 125, 108, 175};
+		check(query(broadphase, player) == bruteQuery(boxes, registered, player), "brute force: Query() of the player's box");
+		for (int i = 0; i < n; i += 7)
+		{
+			check(query(broadphase, boxes[i]) == bruteQuery(boxes, registered, boxes[i]), "brute force: Query() of a registered box");
+		}
+		check(pairs(broadphase) == brutePairs(boxes, registered), "brute force: Pairs()");
+	}
+}
+
+static void edges()
+{
+	// A 3x3 grid of 10x10 boxes that touch their neighbours, plus one sharing the middle box's left edge
+	std::vector<FEHHitbox> boxes;
+	for (int y = 0; y < 3; y++)
+	{
+		for (int x = 0; x < 3; x++)
+		{
+			FEHHitbox b = {x * 10.0f, y * 10.0f, x * 10.0f + 10, y * 10.0f + 10};
+			boxes.push_back(b);
+		}
+	}
+	FEHHitbox sliver = {10, 12, 11, 18};
+	boxes.push_back(sliver);
+	std::vector<bool> registered(boxes.size(), true);
+
+	FEHBroadphase broadphase((int)boxes.size());
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		broadphase.Set(i, boxes[i]);
+	}
+	broadphase.Update();
+
+	PairList expected = brutePairs(boxes, registered);
+	check(expected.size() == 1 && expected[0] == std::make_pair(4, 9), "edges: only the sliver overlaps the middle box");
+	check(pairs(broadphase) == expected, "edges: boxes touching along an edge are no pair");
+
+	FEHHitbox middle = {10, 10, 20, 20}, corner = {20, 20, 30, 30}, gap = {30, 0, 40, 30};
+	check(query(broadphase, middle) == bruteQuery(boxes, registered, middle), "edges: Query() of the middle box");
+	check(query(broadphase, corner) == bruteQuery(boxes, registered, corner), "edges: Query() touching a corner");
+	check(query(broadphase, gap).empty(), "edges: Query() touching the right side finds nothing");
+}
+
+static void removeThenSet()
+{
+	const int n = 8;
+	std::vector<FEHHitbox> boxes(n);
+	std::vector<bool> registered(n, true);
+	FEHBroadphase broadphase(n);
+	for (int i = 0; i < n; i++)
+	{
+		FEHHitbox b = {i * 5.0f, 0, i * 5.0f + 8, 8};
+		boxes[i] = b;
+		broadphase.Set(i, b);
+	}
+	broadphase.Update();
+
+	// A listed id removed and set again before Update() stays listed once, at its new place
+	broadphase.Remove(2);
+	boxes[2].left += 20;
+	boxes[2].right += 20;
+	broadphase.Set(2, boxes[2]);
+
+	// A new id set, removed and set again is added once
+	broadphase.Remove(6);
+	broadphase.Update();
+	registered[6] = false;
+	broadphase.Set(6, boxes[6]);
+	broadphase.Remove(6);
+	broadphase.Set(6, boxes[6]);
+	registered[6] = true;
+
+	// And one removed after Set() is not added at all
+	broadphase.Remove(7);
+	broadphase.Update();
+	broadphase.Set(7, boxes[7]);
+	broadphase.Remove(7);
+	registered[7] = false;
+	broadphase.Update();
+
+	check(broadphase.Count() == n - 1, "remove then set: every id listed once");
+	FEHHitbox all = {-100, -100, 100, 100};
+	check(query(broadphase, all) == bruteQuery(boxes, registered, all), "remove then set: Query() finds each box once");
+	check(pairs(broadphase) == brutePairs(boxes, registered), "remove then set: Pairs()");
+}
+
+static void clearAndReadd()
+{
+	const int n = 16;
+	std::vector<FEHHitbox> boxes(n);
+	std::vector<bool> registered(n, true);
+	FEHBroadphase broadphase(n);
+	for (int i = 0; i < n; i++)
+	{
+		FEHHitbox b = {i * 6.0f, (i % 3) * 4.0f, i * 6.0f + 10, (i % 3) * 4.0f + 10};
+		boxes[i] = b;
+	}
+
+	for (int round = 0; round < 4; round++)
+	{
+		// Every other round registers only the even ids, so some listed ids are not set again
+		broadphase.Clear();
+		for (int i = 0; i < n; i++)
+		{
+			registered[i] = round % 2 == 0 || i % 2 == 0;
+			if (registered[i])
+			{
+				broadphase.Set(i, boxes[i]);
+			}
+		}
+		broadphase.Update();
+
+		check(broadphase.Count() == (round % 2 == 0 ? n : n / 2), "clear: Count() is what was registered since");
+		FEHHitbox all = {-100, -100, 200, 100};
+		check(query(broadphase, all) == bruteQuery(boxes, registered, all), "clear: Query() finds each re-added box once");
+		check(pairs(broadphase) == brutePairs(boxes, registered), "clear: Pairs()");
+	}
+}
+
+static const Test tests[] = {
+	{"broadphase_brute_force", bruteForce},
+	{"broadphase_edges", edges},
+	{"broadphase_remove_then_set", removeThenSet},
+	{"broadphase_clear_and_readd", clearAndReadd},
+};
+
+int main()
+{
+	return runTests(tests);
+}
@@ -0,0 +1,325 @@
+/// @file golden.cpp
+/// @brief Golden-image tests: every drawing primitive, and each screen of the game, must match test/golden/ pixel for pixel
+/// @note Runs headless (make test sets FEH_HEADLESS). The scenes below are drawn here; the game's screens are saved
+/// by playing test/primary.script in the game before this runs. Each scene's drawing is timed as well, so a change that
+/// is meant to be faster can be checked for both. Pass --update to take the current images as the golden ones.
+
+#include "../FEHLCD.h"
+#include "../FEHImages.h"
+#include "../bench/bench.h"
+
+#include <iostream>
+#include <string.h>
+#include <string>
+
+#define OUT_DIR "test/out/"
+#define GOLDEN_DIR "test/golden/"
+
+// Colors that keep neighbouring shapes apart
+static const unsigned int palette[] = {RED, ORANGE, YELLOW, GREEN, CYAN, BLUE, VIOLET, WHITE, GRAY, PINK};
+#define PALETTE_SIZE (int)(sizeof(palette) / sizeof(palette[0]))
+
+static void pixels()
+{
+	int w = LCD.Width(), h = LCD.Height();
+	for (int y = 0; y < h; y += 7)
+	{
+		for (int x = (y / 7) % 3; x < w; x += 5)
+		{
+			LCD.SetFontColor(palette[(x + y) % PALETTE_SIZE]);
+			LCD.DrawPixel(x, y);
+		}
+	}
+
+	// Corners, and positions past the edges
+	LCD.SetFontColor(WHITE);
+	LCD.DrawPixel(0, 0);
+	LCD.DrawPixel(w - 1, 0);
+	LCD.DrawPixel(0, h - 1);
+	LCD.DrawPixel(w - 1, h - 1);
+	LCD.DrawPixel(-3, 10);
+	LCD.DrawPixel(w + 3, 20);
+	LCD.DrawPixel(30, -4);
+	LCD.DrawPixel(40, h + 4);
+}
+
+static void lines()
+{
+	int w = LCD.Width(), h = LCD.Height();
+
+	// A fan of every octant from the middle
+	for (int i = 0; i < 32; i++)
+	{
+		LCD.SetFontColor(palette[i % PALETTE_SIZE]);
+		int x = i < 8 ? i * w / 8 : i < 16 ? w - 1 : i < 24 ? (23 - i) * w / 8 : 0;
+		int y = i < 8 ? 0 : i < 16 ? (i - 8) * h / 8 : i < 24 ? h - 1 : (31 - i) * h / 8;
+		LCD.DrawLine(w / 2, h / 2, x, y);
+	}
+
+	// Running off the screen, and drawn backwards
+	LCD.SetFontColor(WHITE);
+	LCD.DrawLine(-40, 20, w + 40, 60);
+	LCD.DrawLine(w - 10, h + 30, 10, -30);
+	LCD.DrawHorizontalLine(5, 10, w - 10);
+	LCD.DrawHorizontalLine(h - 5, w + 20, -20);
+	LCD.DrawVerticalLine(5, 10, h - 10);
+	LCD.DrawVerticalLine(w - 5, h + 20, -20);
+}
+
+static void rectangles()
+{
+	int w = LCD.Width(), h = LCD.Height();
+	for (int i = 0; i < 12; i++)
+	{
+		LCD.SetFontColor(palette[i % PALETTE_SIZE]);
+		LCD.FillRectangle(10 + i * 24, 10 + i * 8, 20 + i * 3, 15);
+		LCD.SetFontColor(palette[(i + 3) % PALETTE_SIZE]);
+		LCD.DrawRectangle(8 + i * 24, 8 + i * 8, 24 + i * 3, 19);
+	}
+
+	// Hanging off every edge, and too small to see
+	LCD.SetFontColor(YELLOW);
+	LCD.FillRectangle(-10, h / 2, 30, 20);
+	LCD.FillRectangle(w - 20, h / 2, 30, 20);
+	LCD.DrawRectangle(w / 2, -10, 30, 20);
+	LCD.DrawRectangle(w / 2, h - 10, 30, 20);
+	LCD.FillRectangle(100, 200, 0, 0);
+	LCD.DrawRectangle(120, 200, 1, 1);
+}
+
+static void circles()
+{
+	int w = LCD.Width(), h = LCD.Height();
+	for (int i = 0; i < 10; i++)
+	{
+		LCD.SetFontColor(palette[i % PALETTE_SIZE]);
+		LCD.FillCircle(20 + i * 30, 50, i * 2 + 1);
+		LCD.DrawCircle(20 + i * 30, 130, i * 2 + 1);
+	}
+	LCD.SetFontColor(WHITE);
+	LCD.DrawCircle(w / 2, 190, 0);
+	LCD.FillCircle(w / 2 + 10, 190, 0);
+
+	// Cut off by the edges
+	LCD.SetFontColor(ORANGE);
+	LCD.FillCircle(0, h, 40);
+	LCD.DrawCircle(w, h, 40);
+	LCD.FillCircle(w, 0, 25);
+	LCD.DrawCircle(0, 0, 25);
+}
+
+static void text()
+{
+	int w = LCD.Width(), h = LCD.Height();
+
+	// The whole printable character set, wrapping at the right edge
+	char all[96];
+	for (int c = ' '; c <= '~'; c++)
+	{
+		all[c - ' '] = (char)c;
+	}
+	all[95] = '\0';
+	LCD.SetFontColor(WHITE);
+	LCD.SetBackgroundColor(BLACK);
+	LCD.Clear();
+	LCD.WriteLine(all);
+	LCD.SetFontColor(CYAN);
+	LCD.Write(42);
+	LCD.Write(' ');
+	LCD.Write(-3.25f);
+	LCD.Write(' ');
+	LCD.WriteLine(true);
+
+	// Every value type at a pixel and on the grid
+	LCD.SetFontColor(YELLOW);
+	LCD.WriteAt("WriteAt", 3, 100);
+	LCD.WriteAt(12345, 100, 100);
+	LCD.WriteAt(2.5, 180, 100);
+	LCD.WriteRC("RC", 8, 1);
+	LCD.WriteRC(7, 8, 5);
+	LCD.WriteRC('x', 8, 8);
+
+	// Up against and past the edges
+	LCD.SetFontColor(GREEN);
+	LCD.WriteAt("edge", w - 4 * 12, h - 17);
+	LCD.WriteAt("cut", w - 20, 150);
+	LCD.WriteAt("neg", -6, 170);
+	LCD.WriteAt("low", 40, h - 8);
+}
+
+static FEHImage *sprites[4];
+
+static void loadSprites()
+{
+	const char *files[4] = {"../Buttons/sprite_0.png", "../Healed.png", "../Collided.png", "../Logo.png"};
+	for (int i = 0; i < 4; i++)
+	{
+		sprites[i] = new FEHImage(files[i]);
+	}
+}
+
+static void alphaSprites()
+{
+	int w = LCD.Width(), h = LCD.Height();
+
+	// Stripes behind, so see-through pixels show
+	for (int x = 0; x < w; x += 16)
+	{
+		LCD.SetFontColor(palette[(x / 16) % PALETTE_SIZE]);
+		LCD.FillRectangle(x, 0, 16, h);
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		sprites[i]->Draw(10 + i * 70, 10);
+		sprites[i]->DrawSubpixel(10.25f + i * 70 + i * 0.2f, 110.0f);
+	}
+
+	// Clipped at each edge
+	sprites[1]->Draw(-20, 170);
+	sprites[1]->Draw(w - 20, 170);
+	sprites[2]->Draw(w / 2, -30);
+	sprites[2]->DrawSubpixel(w / 2 + 60.5f, h - 20.0f);
+}
+
+static void icons()
+{
+	FEHIcon::Icon grid[6];
+	char labels[6][20] = {"A", "Bee", "Sea", "Dee", "E", "Eff"};
+	FEHIcon::DrawIconArray(grid, 2, 3, 10, 10, 10, 10, labels, BLUE, WHITE);
+}
+
+struct Scene
+{
+	const char *name;
+	void (*draw)();
+};
+
+static const Scene scenes[] = {
+	{"pixels", pixels},
+	{"lines", lines},
+	{"rectangles", rectangles},
+	{"circles", circles},
+	{"text", text},
+	{"alpha_sprites", alphaSprites},
+	{"icons", icons},
+};
+
+// Saved by test/primary.script
+static const char *gameScreens[] = {
+	"primary_menu", "primary_button_held", "primary_info", "primary_credits", "primary_stats",
+	"primary_game_start", "primary_crouch", "primary_jump", "primary_running", "primary_game_over",
+};
+
+// Compare a saved image with its golden one, or make it the golden one
+static bool check(const char *name, bool update, double ms)
+{
+	std::string out = std::string(OUT_DIR) + name + ".png";
+	std::string golden = std::string(GOLDEN_DIR) + name + ".png";
+
+	Tigr *actual = tigrLoadImage(out.c_str());
+	if (!actual)
+	{
+		printf("FAIL %-24s not saved to %s\n", name, out.c_str());
+		return false;
+	}
+
+	if (update)
+	{
+		bool saved = tigrSaveImage(golden.c_str(), actual) != 0;
+		printf("%s %s\n", saved ? "NEW " : "FAIL", name);
+		tigrFree(actual);
+		return saved;
+	}
+
+	Tigr *expected = tigrLoadImage(golden.c_str());
+	bool pass = false;
+	if (!expected)
+	{
+		printf("FAIL %-24s no golden image; make test-update takes the current one\n", name);
+	}
+	else if (expected->w != actual->w || expected->h != actual->h)
+	{
+		printf("FAIL %-24s %dx%d, golden is %dx%d\n", name, actual->w, actual->h, expected->w, expected->h);
+	}
+	else
+	{
+		int differ = 0, first = -1;
+		for (int i = 0; i < actual->w * actual->h; i++)
+		{
+			if (memcmp(&actual->pix[i], &expected->pix[i], sizeof(TPixel)) != 0)
+			{
+				if (first < 0)
+				{
+					first = i;
+				}
+				differ++;
+			}
+		}
+		pass = differ == 0;
+		if (pass)
+		{
+			printf("PASS %-24s", name);
+		}
+		else
+		{
+			printf("FAIL %-24s %d pixels differ, first at (%d, %d)", name, differ, first % actual->w, first / actual->w);
+		}
+		if (ms >= 0)
+		{
+			printf(" %10.3f ms", ms);
+		}
+		printf("\n");
+	}
+
+	tigrFree(actual);
+	if (expected)
+	{
+		tigrFree(expected);
+	}
+	return pass;
+}
+
+int main(int argc, char **argv)
+{
+	bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+	if (!LCD.IsHeadless())
+	{
+		printf("Run with FEH_HEADLESS set, as make test does\n");
+		return 1;
+	}
+
+	loadSprites();
+	int failed = 0;
+
+	for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++)
+	{
+		const Scene &scene = scenes[s];
+
+		// Timed with the Update() that finishes the frame, as a game would see it. The scenes draw past the
+		// edges on purpose, so the out-of-bounds warnings that would print every run are muted
+		std::cout.setstate(std::ios::failbit);
+		double seconds = benchMedian([&]() {
+			LCD.Clear(BLACK);
+			scene.draw();
+			LCD.Update();
+		}, 15);
+		std::cout.clear();
+
+		std::string out = std::string(OUT_DIR) + scene.name + ".png";
+		LCD.Screenshot(out.c_str());
+		failed += !check(scene.name, update, seconds * 1000.0);
+	}
+
+	// The game's screens were timed as it played, see the times it printed
+	for (size_t s = 0; s < sizeof(gameScreens) / sizeof(gameScreens[0]); s++)
+	{
+		failed += !check(gameScreens[s], update, -1);
+	}
+
+	if (failed)
+	{
+		printf("%d of %d images failed\n", failed, (int)(sizeof(scenes) / sizeof(scenes[0]) + sizeof(gameScreens) / sizeof(gameScreens[0])));
+	}
+	return failed ? 1 : 0;
+}
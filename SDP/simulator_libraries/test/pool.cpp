@@ -0,0 +1,143 @@
+/// @file pool.cpp
+/// @brief Tests of tigr's pixel buffer pool: alignment, reuse by size class, the limit on what it keeps, and trimming
+/// @note Needs no screen, so unlike golden.cpp it doesn't link FEHLCD. The counts are read before and after each step,
+/// since the pool is shared by the whole program.
+
+#include "../tigr.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+static TigrPoolStats stats()
+{
+	TigrPoolStats s;
+	tigrPoolStats(&s);
+	return s;
+}
+
+static void alignment()
+{
+	const int sizes[][2] = {{1, 1}, {3, 5}, {17, 9}, {64, 64}, {320, 240}, {333, 77}, {1, 1000}};
+	std::vector<Tigr *> bitmaps;
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		Tigr *bmp = tigrBitmap(sizes[i][0], sizes[i][1]);
+		check(((uintptr_t)bmp->pix & 63) == 0, "alignment: new buffer on a 64-byte boundary");
+		bitmaps.push_back(bmp);
+	}
+
+	// Again once they come from the pool
+	for (size_t i = 0; i < bitmaps.size(); i++)
+	{
+		tigrFree(bitmaps[i]);
+	}
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		Tigr *bmp = tigrBitmap(sizes[i][0], sizes[i][1]);
+		check(((uintptr_t)bmp->pix & 63) == 0, "alignment: reused buffer on a 64-byte boundary");
+		tigrFree(bmp);
+	}
+	tigrPoolTrim();
+}
+
+static void reuse()
+{
+	tigrPoolTrim();
+	TigrPoolStats before = stats();
+
+	Tigr *bmp = tigrBitmap(100, 100);
+	TPixel *pix = bmp->pix;
+	for (int i = 0; i < 100 * 100; i++)
+	{
+		bmp->pix[i] = tigrRGB(1, 2, 3);
+	}
+	tigrFree(bmp);
+	check(stats().pooled == before.pooled + 1, "reuse: freed buffer kept");
+
+	// Same size: the same buffer, cleared like a new one
+	bmp = tigrBitmap(100, 100);
+	TigrPoolStats after = stats();
+	check(bmp->pix == pix, "reuse: same size gets the freed buffer");
+	check(after.reused == before.reused + 1, "reuse: counted as reused");
+	check(after.allocations == before.allocations + 2, "reuse: counted as handed out");
+	check(after.inUse == before.inUse + 1, "reuse: counted as in use");
+	bool cleared = true;
+	for (int i = 0; i < 100 * 100; i++)
+	{
+		cleared = cleared && bmp->pix[i].r == 0 && bmp->pix[i].a == 0;
+	}
+	check(cleared, "reuse: reused buffer cleared");
+	tigrFree(bmp);
+
+	// 10000 pixels round up to a class of 10240, a quarter step above 8192
+	bmp = tigrBitmap(101, 100);
+	check(bmp->pix == pix, "reuse: slightly larger, same class, gets it too");
+	tigrFree(bmp);
+	bmp = tigrBitmap(82, 100);
+	check(bmp->pix == pix, "reuse: slightly smaller, same class, gets it too");
+	tigrFree(bmp);
+	bmp = tigrBitmap(110, 100);
+	check(bmp->pix != pix, "reuse: the next class up does not");
+	tigrFree(bmp);
+	bmp = tigrBitmap(80, 100);
+	check(bmp->pix != pix, "reuse: the next class down does not");
+	tigrFree(bmp);
+	tigrPoolTrim();
+}
+
+static void limit()
+{
+	tigrPoolTrim();
+
+	// 4 MB each, so the 32 MB the pool keeps by default holds 8 of them
+	std::vector<Tigr *> bitmaps;
+	for (int i = 0; i < 12; i++)
+	{
+		bitmaps.push_back(tigrBitmap(1024, 1024));
+	}
+	for (size_t i = 0; i < bitmaps.size(); i++)
+	{
+		tigrFree(bitmaps[i]);
+	}
+
+	TigrPoolStats s = stats();
+	check(s.pooledBytes <= 32 << 20, "limit: no more than 32 MB kept");
+	check(s.pooled == 8, "limit: as many kept as fit");
+	check(s.pooledBytes == s.pooled * (4L << 20), "limit: bytes counted by class");
+	tigrPoolTrim();
+}
+
+static void trim()
+{
+	Tigr *a = tigrBitmap(50, 50), *b = tigrBitmap(500, 50);
+	tigrFree(a);
+	tigrFree(b);
+	check(stats().pooled >= 2, "trim: buffers pooled");
+
+	tigrPoolTrim();
+	TigrPoolStats s = stats();
+	check(s.pooled == 0 && s.pooledBytes == 0, "trim: nothing left pooled");
+
+	// Buffers still in use are not touched, and the pool works after
+	a = tigrBitmap(50, 50);
+	a->pix[0] = tigrRGB(9, 9, 9);
+	tigrPoolTrim();
+	check(a->pix[0].r == 9, "trim: buffers in use left alone");
+	tigrFree(a);
+	check(stats().pooled == 1, "trim: pool still takes buffers");
+	tigrPoolTrim();
+}
+
+static const Test tests[] = {
+	{"pool_alignment", alignment},
+	{"pool_reuse", reuse},
+	{"pool_limit", limit},
+	{"pool_trim", trim},
+};
+
+int main()
+{
+	return runTests(tests);
+}
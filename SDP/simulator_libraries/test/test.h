@@ -0,0 +1,56 @@
+/// @file test.h
+/// @brief Minimal check-and-report harness shared by the library tests in this directory
+/// @note Each test program lists its tests in a table and returns runTests(tests) from main(). Every test prints
+/// PASS or FAIL with its name, followed by the checks that failed in it; make test runs them all.
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+/// @brief One test: a name for the report and the function that runs its checks
+struct Test
+{
+	const char *name;
+	void (*run)();
+};
+
+/// @brief Checks that failed in the test being run
+inline int &failedChecks()
+{
+	static int failed;
+	return failed;
+}
+
+/// @brief Records a failed check in the test being run, printing what was expected
+inline void check(bool ok, const char *what)
+{
+	if (!ok)
+	{
+		printf("     %s\n", what);
+		failedChecks()++;
+	}
+}
+
+/// @brief Runs every test in the table and reports each one
+/// @return 1 if any test failed, else 0, to return from main()
+template <int N>
+int runTests(const Test (&tests)[N])
+{
+	int failed = 0;
+	for (int t = 0; t < N; t++)
+	{
+		failedChecks() = 0;
+		tests[t].run();
+		printf("%s %s\n", failedChecks() ? "FAIL" : "PASS", tests[t].name);
+		failed += failedChecks() > 0;
+	}
+
+	if (failed)
+	{
+		printf("%d of %d tests failed\n", failed, N);
+	}
+	return failed ? 1 : 0;
+}
+
+#endif
@@ -154,6 +154,10 @@ typedef struct {
 	void *glContext;
 	#endif
 	GLuint tex[2];
+	GLuint pbo[2];
+	int pboIndex;
+	int texW, texH;
+	int texStorage;
 	GLuint vao;
 	GLuint program;
 	GLuint uniform_projection;
@@ -165,6 +169,7 @@ typedef struct {
 #endif
 
 #define MAX_TOUCH_POINTS 10
+#define MAX_EVENTS 64
 
 typedef struct {
 	int shown, closed;
@@ -200,6 +205,10 @@ typedef struct {
 	int pos[4];
 	int lastChar;
 	char keys[256], prev[256];
+	TigrEvent events[MAX_EVENTS];
+	int firstEvent, numEvents;
+	int queuedX, queuedY, queuedButtons;
+	char queuedKeys[256];
 	#if defined(__APPLE__)
 	int mouseInView;
 	int mouseButtons;
@@ -208,6 +217,8 @@ typedef struct {
 	int mouseButtons;
 	int mouseX;
 	int mouseY;
+	int width, height;
+	char keysDown[256];
 	#endif // __linux__
 	#ifdef __ANDROID__
 	int numTouchPoints;
@@ -218,6 +229,14 @@ typedef struct {
 
 TigrInternal *tigrInternal(Tigr *bmp);
 
+// Appends an event to a window's input queue, dropping the oldest one if it is full.
+// 'which' is the button of mouse down/up events and the key of key events.
+void tigrQueueEvent(TigrInternal *win, int type, int x, int y, int buttons, int which, double time);
+
+// Queues whatever changed in tigrMouse and the key state since the last call,
+// for platforms that don't queue events as they arrive.
+void tigrQueueInputChanges(Tigr *bmp);
+
 void tigrGAPICreate(Tigr *bmp);
 void tigrGAPIDestroy(Tigr *bmp);
 int  tigrGAPIBegin(Tigr *bmp);
@@ -229,6 +248,7 @@ void tigrGAPIPresent(Tigr *bmp, int w, int h);
 
 //////// End of inlined file: tigr_internal.h ////////
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -250,12 +270,134 @@ void tigrGAPIPresent(Tigr *bmp, int w, int h);
 		return
 
 
+// Pixel buffer pool.
+//
+// Sizes are rounded up to classes a quarter of a power of two apart, and each
+// class keeps a list of freed buffers to hand out again. Every buffer has a
+// header just before its pixels, saying which class it is and where the
+// allocation really starts, so freeing needs no size.
+
+#ifndef TIGR_POOL_LIMIT
+#define TIGR_POOL_LIMIT (32 << 20)
+#endif
+
+#define POOL_ALIGN 64
+#define POOL_MIN_PIXELS 16
+#define POOL_CLASSES (32 * 4)
+
+typedef struct PoolHeader {
+	void *raw;
+	struct PoolHeader *next;
+	int cls;
+} PoolHeader;
+
+static PoolHeader *poolFree[POOL_CLASSES];
+static TigrPoolStats poolStats;
+
+// Like the rest of tigr the pool takes no lock, so bitmaps must be made and
+// freed on one thread. FEHLCD does all of that on the game's thread; its render
+// and draw threads only read and write pixels.
+
+// Class of a pixel count, and the count a class holds.
+static int poolClass(size_t n)
+{
+	int k = 4, step;
+	size_t base;
+	if (n < POOL_MIN_PIXELS)
+		n = POOL_MIN_PIXELS;
+	while (((size_t)2 << k) < n)
+		k++;
+	base = (size_t)1 << k;
+	step = (int)((n - base + base / 4 - 1) / (base / 4));
+	return k * 4 + step;
+}
+
+static size_t poolClassPixels(int cls)
+{
+	size_t base = (size_t)1 << (cls / 4);
+	return base + (cls % 4) * (base / 4);
+}
+
+static TPixel *poolAlloc(int w, int h)
+{
+	size_t n = (w > 0 && h > 0) ? (size_t)w * h : 0;
+	int cls = poolClass(n);
+	PoolHeader *header;
+	char *raw;
+	uintptr_t at;
+
+	header = cls < POOL_CLASSES ? poolFree[cls] : NULL;
+	if (header) {
+		poolFree[cls] = header->next;
+		poolStats.allocations++;
+		poolStats.inUse++;
+		poolStats.reused++;
+		poolStats.pooled--;
+		poolStats.pooledBytes -= (long)(poolClassPixels(cls) * sizeof(TPixel));
+
+		// Bitmaps start out cleared, like fresh ones.
+		memset(header + 1, 0, n * sizeof(TPixel));
+		return (TPixel *)(header + 1);
+	}
+
+	// Room for the header, then enough to move the pixels up to the alignment.
+	raw = (char *)calloc(1, poolClassPixels(cls) * sizeof(TPixel) + sizeof(PoolHeader) + POOL_ALIGN);
+	if (!raw)
+		return NULL;
+	poolStats.allocations++;
+	poolStats.inUse++;
+	at = ((uintptr_t)raw + sizeof(PoolHeader) + POOL_ALIGN - 1) & ~(uintptr_t)(POOL_ALIGN - 1);
+	header = (PoolHeader *)at - 1;
+	header->raw = raw;
+	header->cls = cls;
+	return (TPixel *)at;
+}
+
+static void poolRelease(TPixel *pix)
+{
+	PoolHeader *header;
+	long bytes;
+	if (!pix)
+		return;
+
+	header = (PoolHeader *)pix - 1;
+	bytes = (long)(poolClassPixels(header->cls) * sizeof(TPixel));
+	poolStats.inUse--;
+	if (header->cls < POOL_CLASSES && poolStats.pooledBytes + bytes <= TIGR_POOL_LIMIT) {
+		header->next = poolFree[header->cls];
+		poolFree[header->cls] = header;
+		poolStats.pooled++;
+		poolStats.pooledBytes += bytes;
+	} else {
+		free(header->raw);
+	}
+}
+
+void tigrPoolStats(TigrPoolStats *stats)
+{
+	*stats = poolStats;
+}
+
+void tigrPoolTrim(void)
+{
+	int i;
+	for (i = 0; i < POOL_CLASSES; i++) {
+		while (poolFree[i]) {
+			PoolHeader *next = poolFree[i]->next;
+			free(poolFree[i]->raw);
+			poolFree[i] = next;
+		}
+	}
+	poolStats.pooled = 0;
+	poolStats.pooledBytes = 0;
+}
+
 Tigr *tigrBitmap2(int w, int h, int extra)
 {
 	Tigr *tigr = (Tigr *)calloc(1, sizeof(Tigr) + extra);
 	tigr->w = w;
 	tigr->h = h;
-	tigr->pix = (TPixel *)calloc(w*h, sizeof(TPixel));
+	tigr->pix = poolAlloc(w, h);
 	return tigr;
 }
 
@@ -267,7 +409,7 @@ Tigr *tigrBitmap(int w, int h)
 void tigrResize(Tigr *bmp, int w, int h)
 {
 	int y, cw, ch;
-	TPixel *newpix = (TPixel *)calloc(w*h, sizeof(TPixel));
+	TPixel *newpix = poolAlloc(w, h);
 	cw = (w < bmp->w) ? w : bmp->w;
 	ch = (h < bmp->h) ? h : bmp->h;
 
@@ -275,7 +417,7 @@ void tigrResize(Tigr *bmp, int w, int h)
 	for (y=0;y<ch;y++)
 		memcpy(newpix+y*w, bmp->pix+y*bmp->w, cw*sizeof(TPixel));
 
-	free(bmp->pix);
+	poolRelease(bmp->pix);
 	bmp->pix = newpix;
 	bmp->w = w;
 	bmp->h = h;
@@ -316,6 +458,87 @@ void tigrPosition(Tigr *bmp, int scale, int windowW, int windowH, int out[4])
 	out[3] = out[1] + bmp->h*scale;
 }
 
+void tigrQueueEvent(TigrInternal *win, int type, int x, int y, int buttons, int which, double time)
+{
+	TigrEvent *e;
+
+	// When nobody reads the queue, keep the newest events.
+	if (win->numEvents == MAX_EVENTS) {
+		win->firstEvent = (win->firstEvent + 1) % MAX_EVENTS;
+		win->numEvents--;
+	}
+
+	e = &win->events[(win->firstEvent + win->numEvents) % MAX_EVENTS];
+	e->type = type;
+	e->x = x;
+	e->y = y;
+	e->buttons = buttons;
+	e->button = (type == TIGR_EVENT_MOUSE_DOWN || type == TIGR_EVENT_MOUSE_UP) ? which : 0;
+	e->key = (type == TIGR_EVENT_KEY_DOWN || type == TIGR_EVENT_KEY_UP) ? which : 0;
+	e->time = time;
+	win->numEvents++;
+}
+
+int tigrPollEvent(Tigr *bmp, TigrEvent *event)
+{
+	TigrInternal *win = tigrInternal(bmp);
+	if (win->numEvents == 0)
+		return 0;
+
+	*event = win->events[win->firstEvent];
+	win->firstEvent = (win->firstEvent + 1) % MAX_EVENTS;
+	win->numEvents--;
+	return 1;
+}
+
+#ifdef _WIN32
+double tigrClock()
+{
+	LARGE_INTEGER freq, now;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (double)now.QuadPart / (double)freq.QuadPart;
+}
+#else
+#include <time.h>
+double tigrClock()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (ts.tv_nsec / 1000000000.0);
+}
+#endif
+
+void tigrQueueInputChanges(Tigr *bmp)
+{
+	TigrInternal *win = tigrInternal(bmp);
+	double time = tigrClock();
+	int x, y, buttons, key, bit;
+
+	tigrMouse(bmp, &x, &y, &buttons);
+	if (x != win->queuedX || y != win->queuedY)
+		tigrQueueEvent(win, TIGR_EVENT_MOUSE_MOVE, x, y, win->queuedButtons, 0, time);
+
+	// One event per button, so a press and a release are never merged.
+	for (bit = 1; bit <= 4; bit <<= 1) {
+		if ((buttons & bit) != (win->queuedButtons & bit)) {
+			win->queuedButtons ^= bit;
+			tigrQueueEvent(win, (buttons & bit) ? TIGR_EVENT_MOUSE_DOWN : TIGR_EVENT_MOUSE_UP, x, y, win->queuedButtons, bit, time);
+		}
+	}
+	win->queuedX = x;
+	win->queuedY = y;
+
+	// tigrKeyHeld maps TKey codes to the platform's own
+	for (key = 1; key < 256; key++) {
+		char held = tigrKeyHeld(bmp, key) ? 1 : 0;
+		if (held != win->queuedKeys[key]) {
+			win->queuedKeys[key] = held;
+			tigrQueueEvent(win, held ? TIGR_EVENT_KEY_DOWN : TIGR_EVENT_KEY_UP, x, y, buttons, key, time);
+		}
+	}
+}
+
 void tigrClear(Tigr *bmp, TPixel color)
 {
 	int count = bmp->w * bmp->h;
@@ -434,6 +657,28 @@ void tigrBlitTint(Tigr *dst, Tigr *src, int dx, int dy, int sx, int sy, int w, i
 	td = &dst->pix[dy*dst->w + dx];
 	st = src->w;
 	dt = dst->w;
+
+	// Without a tint, opaque pixels blend to a copy and clear ones to nothing.
+	// Images are mostly one or the other, so skip the arithmetic for them.
+	if (xr == 256 && xg == 256 && xb == 256 && xa == 256) {
+		do {
+			for (x=0;x<w;x++)
+			{
+				unsigned a;
+				if (ts[x].a == 0xff) { td[x] = ts[x]; continue; }
+				if (ts[x].a == 0) continue;
+				a = 256 * EXPAND(ts[x].a);
+				td[x].r += (unsigned char)((ts[x].r - td[x].r)*a >> 16);
+				td[x].g += (unsigned char)((ts[x].g - td[x].g)*a >> 16);
+				td[x].b += (unsigned char)((ts[x].b - td[x].b)*a >> 16);
+				td[x].a += (unsigned char)((ts[x].a - td[x].a)*a >> 16);
+			}
+			ts += st;
+			td += dt;
+		} while(--h);
+		return;
+	}
+
 	do {
 		for (x=0;x<w;x++)
 		{
@@ -457,6 +702,285 @@ void tigrBlitAlpha(Tigr *dst, Tigr *src, int dx, int dy, int sx, int sy, int w,
 	tigrBlitTint(dst, src, dx, dy, sx, sy, w, h, tigrRGBA(0xff,0xff,0xff,(unsigned char)(alpha*255)));
 }
 
+void tigrBlitSubpixel(Tigr *dst, Tigr *src, float fdx, float fdy, int sx, int sy, int w, int h, float alpha)
+{
+	TPixel *td, *ts;
+	TPixel empty = { 0,0,0,0 };
+	int x, x0, x1, st, dt, dx, dy, fx, wl, wr, xa;
+
+	// Split the position into whole pixels and a fraction in 1/256ths.
+	dx = (int)fdx; if (dx > fdx) dx--;
+	dy = (int)fdy; if (dy > fdy) dy--;
+	fx = (int)((fdx - dx) * 256.0f + 0.5f);
+	if (fx >= 256) { dx++; fx = 0; }
+
+	// Whole-pixel positions take the regular path, so the output is unchanged.
+	if (fx == 0) {
+		tigrBlitAlpha(dst, src, dx, dy, sx, sy, w, h, alpha);
+		return;
+	}
+
+	alpha = (alpha < 0) ? 0 : (alpha > 1 ? 1 : alpha);
+	xa = EXPAND((int)(alpha*255));
+
+	// Clip the source rect to the source bitmap, and rows to the destination.
+	if (sx < 0) { w += sx; sx = 0; }
+	if (sy < 0) { h += sy; sy = 0; }
+	if (sx + w > src->w) w = src->w - sx;
+	if (sy + h > src->h) h = src->h - sy;
+	if (dy < 0) { h += dy; sy -= dy; dy = 0; }
+	if (dy + h > dst->h) h = dst->h - dy;
+	if (w <= 0 || h <= 0)
+		return;
+
+	// Output column x blends source columns x-1 (weight fx) and x (weight 256-fx).
+	x0 = (dx < 0) ? -dx : 0;
+	x1 = (dx + w + 1 > dst->w) ? dst->w - dx : w + 1;
+	if (x0 >= x1)
+		return;
+
+	wl = fx;
+	wr = 256 - fx;
+	ts = &src->pix[sy*src->w + sx];
+	td = &dst->pix[dy*dst->w + dx];
+	st = src->w;
+	dt = dst->w;
+	do {
+		for (x=x0;x<x1;x++)
+		{
+			TPixel l = (x > 0) ? ts[x-1] : empty;
+			TPixel r = (x < w) ? ts[x] : empty;
+			unsigned la, ra, a, ia;
+			if (!(l.a | r.a))
+				continue;
+
+			// Two opaque taps at full alpha cover the pixel: a plain lerp,
+			// which matches the general path below bit for bit.
+			if (xa == 256 && (l.a & r.a) == 255) {
+				td[x].r = (unsigned char)((l.r * wl + r.r * wr) >> 8);
+				td[x].g = (unsigned char)((l.g * wl + r.g * wr) >> 8);
+				td[x].b = (unsigned char)((l.b * wl + r.b * wr) >> 8);
+				td[x].a = 255;
+				continue;
+			}
+
+			// Filter premultiplied colors; a ends up in 0..65535.
+			la = l.a * wl;
+			ra = r.a * wr;
+			a = ((la + ra) * xa) >> 8;
+			a += a >> 8;
+			ia = 65536 - a;
+
+#define BLEND(C, V) { unsigned v = (V) + ((td[x].C * ia) >> 16); td[x].C = (unsigned char)(v > 255 ? 255 : v); }
+#define TAP(C) ((((((l.C * la + r.C * ra) >> 8) * xa) >> 8) * 257 + 257) >> 16)
+			BLEND(r, TAP(r));
+			BLEND(g, TAP(g));
+			BLEND(b, TAP(b));
+			BLEND(a, a >> 8);
+#undef TAP
+#undef BLEND
+		}
+		ts += st;
+		td += dt;
+	} while(--h);
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TIGR_SSE2
+#include <emmintrin.h>
+#endif
+
+// Writes each pixel of a row factor times in a row.
+static void tigrStretchRow(TPixel *td, const TPixel *ts, int w, int factor)
+{
+	int x = 0, i;
+#ifdef TIGR_SSE2
+	// Four pixels at a time, repeated with shuffles.
+	if (factor == 2) {
+		for (; x + 4 <= w; x += 4, td += 8) {
+			__m128i p = _mm_loadu_si128((const __m128i *)(ts + x));
+			_mm_storeu_si128((__m128i *)td, _mm_unpacklo_epi32(p, p));
+			_mm_storeu_si128((__m128i *)(td + 4), _mm_unpackhi_epi32(p, p));
+		}
+	} else if (factor == 3) {
+		for (; x + 4 <= w; x += 4, td += 12) {
+			__m128i p = _mm_loadu_si128((const __m128i *)(ts + x));
+			_mm_storeu_si128((__m128i *)td, _mm_shuffle_epi32(p, _MM_SHUFFLE(1,0,0,0)));
+			_mm_storeu_si128((__m128i *)(td + 4), _mm_shuffle_epi32(p, _MM_SHUFFLE(2,2,1,1)));
+			_mm_storeu_si128((__m128i *)(td + 8), _mm_shuffle_epi32(p, _MM_SHUFFLE(3,3,3,2)));
+		}
+	} else if (factor == 4) {
+		for (; x + 4 <= w; x += 4, td += 16) {
+			__m128i p = _mm_loadu_si128((const __m128i *)(ts + x));
+			_mm_storeu_si128((__m128i *)td, _mm_shuffle_epi32(p, _MM_SHUFFLE(0,0,0,0)));
+			_mm_storeu_si128((__m128i *)(td + 4), _mm_shuffle_epi32(p, _MM_SHUFFLE(1,1,1,1)));
+			_mm_storeu_si128((__m128i *)(td + 8), _mm_shuffle_epi32(p, _MM_SHUFFLE(2,2,2,2)));
+			_mm_storeu_si128((__m128i *)(td + 12), _mm_shuffle_epi32(p, _MM_SHUFFLE(3,3,3,3)));
+		}
+	}
+#endif
+	for (; x < w; x++)
+		for (i = 0; i < factor; i++)
+			*td++ = ts[x];
+}
+
+int tigrScaleNearest(Tigr *dst, Tigr *src, int factor)
+{
+	int y, i, dw;
+	TPixel *td;
+
+	if (factor < 1 || dst->w != src->w * factor || dst->h != src->h * factor)
+		return 0;
+
+	// Stretch each row once, then copy it down.
+	dw = dst->w;
+	td = dst->pix;
+	for (y=0;y<src->h;y++) {
+		tigrStretchRow(td, src->pix + y*src->w, src->w, factor);
+		for (i=1;i<factor;i++)
+			memcpy(td + i*dw, td, dw*sizeof(TPixel));
+		td += factor*dw;
+	}
+	return 1;
+}
+
+// Pixels are compared whole, alpha included.
+static unsigned tigrBits(TPixel p)
+{
+	unsigned u;
+	memcpy(&u, &p, sizeof(u));
+	return u;
+}
+
+// Scale2x: a pixel P with neighbors A above, B right, C left and D below becomes
+//   E0 E1    E0 = A if C == A, E1 = B if A == B,
+//   E2 E3    E2 = C if C == D, E3 = D if B == D,
+// unless A == D or B == C, where all four stay P. Edges repeat the border pixels.
+static void tigrScale2xPixel(TPixel *d0, TPixel *d1, const TPixel *up, const TPixel *row, const TPixel *dn, int x, int w)
+{
+	TPixel p = row[x], a = up[x], d = dn[x];
+	TPixel c = row[x > 0 ? x-1 : x], b = row[x < w-1 ? x+1 : x];
+	unsigned A = tigrBits(a), B = tigrBits(b), C = tigrBits(c), D = tigrBits(d);
+
+	d0[2*x] = d0[2*x+1] = d1[2*x] = d1[2*x+1] = p;
+	if (A != D && C != B) {
+		if (C == A) d0[2*x] = a;
+		if (A == B) d0[2*x+1] = b;
+		if (C == D) d1[2*x] = c;
+		if (B == D) d1[2*x+1] = d;
+	}
+}
+
+static void tigrScale2x(Tigr *dst, Tigr *src)
+{
+	int x, y, w = src->w, h = src->h;
+	for (y=0;y<h;y++) {
+		const TPixel *up = src->pix + (y > 0 ? y-1 : y)*w;
+		const TPixel *row = src->pix + y*w;
+		const TPixel *dn = src->pix + (y < h-1 ? y+1 : y)*w;
+		TPixel *d0 = dst->pix + 2*y*dst->w;
+		TPixel *d1 = d0 + dst->w;
+
+		x = 0;
+#ifdef TIGR_SSE2
+		// The same rule on four pixels at once, away from the left and right edges.
+		if (w > 5) {
+			tigrScale2xPixel(d0, d1, up, row, dn, 0, w);
+			for (x=1; x + 5 <= w; x += 4) {
+				__m128i a = _mm_loadu_si128((const __m128i *)(up + x));
+				__m128i d = _mm_loadu_si128((const __m128i *)(dn + x));
+				__m128i p = _mm_loadu_si128((const __m128i *)(row + x));
+				__m128i b = _mm_loadu_si128((const __m128i *)(row + x + 1));
+				__m128i c = _mm_loadu_si128((const __m128i *)(row + x - 1));
+				__m128i keep = _mm_or_si128(_mm_cmpeq_epi32(a, d), _mm_cmpeq_epi32(c, b));
+				__m128i m0 = _mm_andnot_si128(keep, _mm_cmpeq_epi32(c, a));
+				__m128i m1 = _mm_andnot_si128(keep, _mm_cmpeq_epi32(a, b));
+				__m128i m2 = _mm_andnot_si128(keep, _mm_cmpeq_epi32(c, d));
+				__m128i m3 = _mm_andnot_si128(keep, _mm_cmpeq_epi32(b, d));
+				__m128i e0 = _mm_or_si128(_mm_and_si128(m0, a), _mm_andnot_si128(m0, p));
+				__m128i e1 = _mm_or_si128(_mm_and_si128(m1, b), _mm_andnot_si128(m1, p));
+				__m128i e2 = _mm_or_si128(_mm_and_si128(m2, c), _mm_andnot_si128(m2, p));
+				__m128i e3 = _mm_or_si128(_mm_and_si128(m3, d), _mm_andnot_si128(m3, p));
+				_mm_storeu_si128((__m128i *)(d0 + 2*x), _mm_unpacklo_epi32(e0, e1));
+				_mm_storeu_si128((__m128i *)(d0 + 2*x + 4), _mm_unpackhi_epi32(e0, e1));
+				_mm_storeu_si128((__m128i *)(d1 + 2*x), _mm_unpacklo_epi32(e2, e3));
+				_mm_storeu_si128((__m128i *)(d1 + 2*x + 4), _mm_unpackhi_epi32(e2, e3));
+			}
+		}
+#endif
+		for (; x < w; x++)
+			tigrScale2xPixel(d0, d1, up, row, dn, x, w);
+	}
+}
+
+// Scale3x: the 3x3 version of the same rule, with the neighborhood
+//   A B C
+//   D E F
+//   G H I
+static void tigrScale3x(Tigr *dst, Tigr *src)
+{
+	int x, y, i, w = src->w, h = src->h, dw = dst->w;
+	for (y=0;y<h;y++) {
+		const TPixel *up = src->pix + (y > 0 ? y-1 : y)*w;
+		const TPixel *row = src->pix + y*w;
+		const TPixel *dn = src->pix + (y < h-1 ? y+1 : y)*w;
+		TPixel *td = dst->pix + 3*y*dw;
+
+		for (x=0;x<w;x++) {
+			int l = x > 0 ? x-1 : x, r = x < w-1 ? x+1 : x;
+			unsigned A = tigrBits(up[l]), B = tigrBits(up[x]), C = tigrBits(up[r]);
+			unsigned D = tigrBits(row[l]), E = tigrBits(row[x]), F = tigrBits(row[r]);
+			unsigned G = tigrBits(dn[l]), H = tigrBits(dn[x]), I = tigrBits(dn[r]);
+			TPixel e[9];
+
+			for (i=0;i<9;i++)
+				e[i] = row[x];
+			if (B != H && D != F) {
+				if (D == B) e[0] = row[l];
+				if ((D == B && E != C) || (B == F && E != A)) e[1] = up[x];
+				if (B == F) e[2] = row[r];
+				if ((D == B && E != G) || (D == H && E != A)) e[3] = row[l];
+				if ((B == F && E != I) || (H == F && E != C)) e[5] = row[r];
+				if (D == H) e[6] = row[l];
+				if ((D == H && E != I) || (H == F && E != G)) e[7] = dn[x];
+				if (H == F) e[8] = row[r];
+			}
+
+			for (i=0;i<3;i++) {
+				td[i*dw + 3*x] = e[3*i];
+				td[i*dw + 3*x + 1] = e[3*i + 1];
+				td[i*dw + 3*x + 2] = e[3*i + 2];
+			}
+		}
+	}
+}
+
+int tigrScaleSmooth(Tigr *dst, Tigr *src, int factor)
+{
+	if (factor < 1 || dst->w != src->w * factor || dst->h != src->h * factor)
+		return 0;
+
+	switch (factor) {
+	case 2:
+		tigrScale2x(dst, src);
+		return 1;
+	case 3:
+		tigrScale3x(dst, src);
+		return 1;
+	case 4: {
+		// Scale4x is Scale2x twice. The middle step comes from the bitmap pool,
+		// so redrawing at the same size reuses the last one's pixels.
+		Tigr *half = tigrBitmap(src->w * 2, src->h * 2);
+		tigrScale2x(half, src);
+		tigrScale2x(dst, half);
+		tigrFree(half);
+		return 1;
+	}
+	default:
+		return tigrScaleNearest(dst, src, factor);
+	}
+}
+
 #undef CLIP0
 #undef CLIP1
 #undef CLIP
@@ -742,28 +1266,50 @@ Tigr *tigrLoadImage(const char *fileName)
 #include <string.h>
 #include <errno.h>
 
+// The whole file is built in memory, then written with a single fwrite.
 typedef struct {
-	unsigned crc, adler, bits, prev, runlen;
-	FILE *out;
-	unsigned crcTable[256];
+	unsigned char *data;
+	size_t len, cap;
+	unsigned bits;
+	int nbits;
+	int failed;
 } Save;
 
-static const unsigned crctable[16] = { 0, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
-	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
+static void reserve(Save *s, size_t extra)
+{
+	unsigned char *data;
+	size_t cap;
+	if (s->len + extra <= s->cap || s->failed)
+		return;
+	cap = s->cap ? s->cap : 4096;
+	while (cap < s->len + extra)
+		cap *= 2;
+	data = (unsigned char *)realloc(s->data, cap);
+	if (!data) {
+		s->failed = 1;
+		return;
+	}
+	s->data = data;
+	s->cap = cap;
+}
 
 static void put(Save *s, unsigned v)
 {
-	fputc(v, s->out);
-	s->crc = (s->crc >> 4) ^ crctable[(s->crc & 15) ^ (v & 15)];
-	s->crc = (s->crc >> 4) ^ crctable[(s->crc & 15) ^ (v >> 4)];
+	if (s->len == s->cap) {
+		reserve(s, 1);
+		if (s->failed)
+			return;
+	}
+	s->data[s->len++] = (unsigned char)v;
 }
 
-static void updateAdler(Save *s, unsigned v)
+static void putBytes(Save *s, const void *p, size_t n)
 {
-	unsigned s1 = s->adler & 0xffff, s2 = (s->adler >> 16) & 0xffff;
-	s1 = (s1 +  v) % 65521;
-	s2 = (s2 + s1) % 65521;
-	s->adler = (s2 << 16) + s1;
+	reserve(s, n);
+	if (!s->failed && n) {
+		memcpy(s->data + s->len, p, n);
+		s->len += n;
+	}
 }
 
 static void put32(Save *s, unsigned v)
@@ -774,160 +1320,602 @@ static void put32(Save *s, unsigned v)
 	put(s, v & 0xff);
 }
 
-void putbits(Save *s, unsigned data, unsigned bitcount)
+// Deflate packs bits starting from the least significant.
+static void putbits(Save *s, unsigned data, int count)
 {
-	while (bitcount--)
-	{
-		unsigned prev = s->bits;
-		s->bits = (s->bits >> 1) | ((data & 1) << 7);
-		data >>= 1;
-		if (prev & 1)
-		{
-			put(s, s->bits);
-			s->bits = 0x80;
+	s->bits |= data << s->nbits;
+	s->nbits += count;
+	while (s->nbits >= 8) {
+		put(s, s->bits & 0xff);
+		s->bits >>= 8;
+		s->nbits -= 8;
+	}
+}
+
+static void flushbits(Save *s)
+{
+	if (s->nbits > 0)
+		put(s, s->bits & 0xff);
+	s->bits = 0;
+	s->nbits = 0;
+}
+
+// Four tables, so the CRC can take a word at a time ("slicing by 4").
+static void makeCrcTable(unsigned table[4][256])
+{
+	unsigned n, k, c;
+	for (n=0;n<256;n++) {
+		c = n;
+		for (k=0;k<8;k++)
+			c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+		table[0][n] = c;
+	}
+	for (n=0;n<256;n++)
+		for (k=1;k<4;k++)
+			table[k][n] = table[0][table[k-1][n] & 0xff] ^ (table[k-1][n] >> 8);
+}
+
+static unsigned crc32(unsigned table[4][256], const unsigned char *p, size_t n)
+{
+	unsigned crc = 0xffffffff;
+	for (; n >= 4; n -= 4, p += 4) {
+		crc ^= (unsigned)p[0] | ((unsigned)p[1] << 8) | ((unsigned)p[2] << 16) | ((unsigned)p[3] << 24);
+		crc = table[3][crc & 0xff] ^ table[2][(crc >> 8) & 0xff] ^ table[1][(crc >> 16) & 0xff] ^ table[0][crc >> 24];
+	}
+	while (n--)
+		crc = table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+static unsigned adler32(const unsigned char *p, size_t n)
+{
+	unsigned s1 = 1, s2 = 0;
+	while (n) {
+		// 5552 bytes is the most that can be summed before s2 could overflow.
+		size_t k = n < 5552 ? n : 5552;
+		n -= k;
+		while (k--) {
+			s1 += *p++;
+			s2 += s1;
 		}
+		s1 %= 65521;
+		s2 %= 65521;
 	}
+	return (s2 << 16) | s1;
 }
 
-void putbitsr(Save *s, unsigned data, unsigned bitcount)
+// Row filters ------------------------------------------------------------
+
+#ifdef TIGR_SSE2
+// The paeth predictor for eight bytes at once, widened to 16 bits.
+static __m128i paeth16(__m128i a, __m128i b, __m128i c)
 {
-	while (bitcount--)
-		putbits(s, data >> bitcount, 1);
+	__m128i zero = _mm_setzero_si128();
+	__m128i pa = _mm_sub_epi16(b, c), pb = _mm_sub_epi16(a, c), pc = _mm_add_epi16(pa, pb);
+	__m128i notA, bOverC, bc;
+	pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+	pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+	pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+	notA = _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc));
+	bOverC = _mm_cmpgt_epi16(pb, pc);
+	bc = _mm_or_si128(_mm_and_si128(bOverC, c), _mm_andnot_si128(bOverC, b));
+	return _mm_or_si128(_mm_and_si128(notA, bc), _mm_andnot_si128(notA, a));
+}
+#endif
+
+// Filters a row from its second pixel on, as many bytes at once as it can, adding to sum.
+// Returns the index of the first byte it left for filterRow.
+static int filterRowWide(unsigned char *out, const unsigned char *row, const unsigned char *prior, int n, int filter, unsigned *sum, unsigned limit)
+{
+	int i = 4;
+#ifdef TIGR_SSE2
+	__m128i zero = _mm_setzero_si128(), total = zero;
+	for (; i + 16 <= n; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(row + i));
+		__m128i a = _mm_loadu_si128((const __m128i *)(row + i - 4));
+		__m128i b = _mm_loadu_si128((const __m128i *)(prior + i));
+		__m128i c = _mm_loadu_si128((const __m128i *)(prior + i - 4));
+		__m128i p, d;
+		switch (filter) {
+		case 0: p = zero; break;
+		case 1: p = a; break;
+		case 2: p = b; break;
+		// _mm_avg_epu8 rounds up; take the odd bit back off.
+		case 3: p = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1))); break;
+		default:
+			p = _mm_packus_epi16(
+				paeth16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero)),
+				paeth16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero)));
+			break;
+		}
+		d = _mm_sub_epi8(x, p);
+		_mm_storeu_si128((__m128i *)(out + i), d);
+		// Absolute values of the signed bytes, summed.
+		total = _mm_add_epi64(total, _mm_sad_epu8(_mm_min_epu8(d, _mm_sub_epi8(zero, d)), zero));
+		if (*sum + (unsigned)_mm_cvtsi128_si32(total) + (unsigned)_mm_cvtsi128_si32(_mm_srli_si128(total, 8)) >= limit)
+			break;
+	}
+	*sum += (unsigned)_mm_cvtsi128_si32(total) + (unsigned)_mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+#else
+	(void)out; (void)row; (void)prior; (void)n; (void)filter; (void)sum; (void)limit;
+#endif
+	return i;
+}
+
+// Applies filter 0-4 (none, sub, up, average, paeth) to a row of n bytes and returns
+// the sum of the result as signed bytes, or just limit once the sum gets that far.
+static unsigned filterRow(unsigned char *out, const unsigned char *row, const unsigned char *prior, int n, int filter, unsigned limit)
+{
+	unsigned sum = 0;
+	int i;
+
+	// The first pixel has nothing to its left.
+	#define FILTER(FIRST, REST) \
+		for (i=0;i<4;i++) { out[i] = row[i] - (unsigned char)(FIRST); sum += abs((signed char)out[i]); } \
+		i = filterRowWide(out, row, prior, n, filter, &sum, limit); \
+		for (;i<n && sum<limit;i++) { \
+			out[i] = row[i] - (unsigned char)(REST); \
+			sum += abs((signed char)out[i]); \
+		}
+
+	switch (filter) {
+	case 0: FILTER(0, 0); break;
+	case 1: FILTER(0, row[i-4]); break;
+	case 2: FILTER(prior[i], prior[i]); break;
+	case 3: FILTER(prior[i] >> 1, (row[i-4] + prior[i]) >> 1); break;
+	case 4: FILTER(prior[i], paeth(row[i-4], prior[i], prior[i-4])); break;
+	}
+	#undef FILTER
+	return sum < limit ? sum : limit;
+}
+
+// Lays out the image as PNG scanlines, each a filter byte and the filtered pixels.
+// When asked to choose, each row gets the filter that leaves the smallest sum of
+// (signed) bytes, as libpng does; otherwise rows are left unfiltered.
+static unsigned char *filterImage(Tigr *bmp, int choose, size_t *size)
+{
+	int y, f, n = bmp->w * 4;
+	unsigned char *out = (unsigned char *)malloc((size_t)bmp->h * (n + 1));
+	unsigned char *zero = (unsigned char *)calloc(n, 1);
+	unsigned char *scratch = (unsigned char *)malloc(2 * n);
+	if (!out || !zero || !scratch) {
+		free(out); free(zero); free(scratch);
+		return NULL;
+	}
+
+	for (y=0;y<bmp->h;y++) {
+		const unsigned char *row = (const unsigned char *)&bmp->pix[y*bmp->w];
+		const unsigned char *prior = y > 0 ? (const unsigned char *)&bmp->pix[(y-1)*bmp->w] : zero;
+		unsigned char *line = out + (size_t)y * (n + 1);
+		unsigned char *best = scratch, *trial = scratch + n, *swap;
+		unsigned bestSum, sum;
+
+		line[0] = 0;
+		if (!choose) {
+			memcpy(line + 1, row, n);
+			continue;
+		}
+
+		bestSum = filterRow(best, row, prior, n, 0, ~0u);
+		for (f=1;f<=4;f++) {
+			sum = filterRow(trial, row, prior, n, f, bestSum);
+			if (sum < bestSum) {
+				bestSum = sum;
+				line[0] = (unsigned char)f;
+				swap = best; best = trial; trial = swap;
+			}
+		}
+		memcpy(line + 1, best, n);
+	}
+
+	free(zero);
+	free(scratch);
+	*size = (size_t)bmp->h * (n + 1);
+	return out;
 }
 
-static void begin(Save *s, const char *id, unsigned len)
+// Deflate ----------------------------------------------------------------
+
+static const unsigned short saveLenBase[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+static const unsigned char saveLenExtra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+static const unsigned short saveDistBase[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+static const unsigned char saveDistExtra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+static const unsigned char saveLengthOrder[19] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+
+#define SAVE_HASH_BITS 15
+#define SAVE_WINDOW 32768
+#define SAVE_BLOCK_TOKENS 65536
+
+static int floorLog2(unsigned v)
 {
-	put32(s, len);
-	s->crc = 0xffffffff;
-	put(s, id[0]); put(s, id[1]); put(s, id[2]); put(s, id[3]);
+	int n = 0;
+	while (v >>= 1) n++;
+	return n;
 }
 
-static void literal(Save *s, unsigned v)
+static int lengthCode(int len)
 {
-	// Encode a literal/length using the built-in tables.
-	// Could do better with a custom table but whatever.
-	     if (v < 144)   putbitsr(s, 0x030+v-  0, 8);
-	else if (v < 256)   putbitsr(s, 0x190+v-144, 9);
-	else if (v < 280)   putbitsr(s, 0x000+v-256, 7);
-	else                putbitsr(s, 0x0c0+v-280, 8);
+	int l = len - 3, lg;
+	if (l < 8) return l;
+	if (l == 255) return 28;
+	lg = floorLog2(l);
+	return 4*(lg-1) + ((l >> (lg-2)) & 3);
 }
 
-static void encodelen(Save *s, unsigned code, unsigned bits, unsigned len)
+static int distCode(int dist)
 {
-	literal(s, code + (len >> bits));
-	putbits(s, len, bits);
-	putbits(s, 0, 5);
+	int d = dist - 1, lg;
+	if (d < 4) return d;
+	lg = floorLog2(d);
+	return 2*lg + ((d >> (lg-1)) & 1);
 }
 
-static void endrun(Save *s)
+// Builds Huffman code lengths of at most maxBits for n symbols.
+// Too-deep trees are flattened by halving the frequencies and trying again.
+static void buildLengths(const unsigned *freq, int n, int maxBits, unsigned char *lengths)
 {
-	s->runlen--;
-	literal(s, s->prev);
+	unsigned keys[288], weight[576], scaled[288];
+	int parent[576], depth[576];
+	int i, j, k, count, leaf, node, maxDepth;
+
+	for (i=0;i<n;i++)
+		scaled[i] = freq[i];
+
+	for (;;) {
+		memset(lengths, 0, n);
+		count = 0;
+		for (i=0;i<n;i++)
+			if (scaled[i])
+				keys[count++] = (scaled[i] << 9) | i;
+
+		// A code needs two symbols to be complete; add a dummy one.
+		if (count < 2) {
+			lengths[count == 1 && (keys[0] & 511) == 0 ? 1 : 0] = 1;
+			if (count == 1)
+				lengths[keys[0] & 511] = 1;
+			return;
+		}
+
+		// Sort leaves by weight; merged nodes then come out in order too (two-queue Huffman).
+		for (i=1;i<count;i++) {
+			unsigned key = keys[i];
+			for (j=i; j>0 && keys[j-1] > key; j--)
+				keys[j] = keys[j-1];
+			keys[j] = key;
+		}
+		for (i=0;i<count;i++)
+			weight[i] = keys[i] >> 9;
+
+		leaf = 0;
+		node = count;
+		for (k=count;k<2*count-1;k++) {
+			int pick[2];
+			for (j=0;j<2;j++) {
+				if (leaf < count && (node >= k || weight[leaf] <= weight[node]))
+					pick[j] = leaf++;
+				else
+					pick[j] = node++;
+			}
+			weight[k] = weight[pick[0]] + weight[pick[1]];
+			parent[pick[0]] = parent[pick[1]] = k;
+		}
 
-	     if (s->runlen >= 67) encodelen(s, 277, 4, s->runlen - 67);
-	else if (s->runlen >= 35) encodelen(s, 273, 3, s->runlen - 35);
-	else if (s->runlen >= 19) encodelen(s, 269, 2, s->runlen - 19);
-	else if (s->runlen >= 11) encodelen(s, 265, 1, s->runlen - 11);
-	else if (s->runlen >=  3) encodelen(s, 257, 0, s->runlen -  3);
-	else while (s->runlen--) literal(s, s->prev);
+		depth[2*count-2] = 0;
+		maxDepth = 0;
+		for (k=2*count-3;k>=0;k--) {
+			depth[k] = depth[parent[k]] + 1;
+			if (k < count && depth[k] > maxDepth)
+				maxDepth = depth[k];
+		}
+		if (maxDepth <= maxBits) {
+			for (i=0;i<count;i++)
+				lengths[keys[i] & 511] = (unsigned char)depth[i];
+			return;
+		}
+
+		for (i=0;i<n;i++)
+			if (scaled[i])
+				scaled[i] = (scaled[i] >> 1) | 1;
+	}
 }
 
-static void encodeByte(Save *s, unsigned char v)
+// Canonical codes for the lengths, bit-reversed since deflate sends codes from the top bit.
+static void buildCodes(const unsigned char *lengths, int n, unsigned short *codes)
 {
-	updateAdler(s, v);
+	int count[16] = { 0 }, next[16];
+	int i, b, code = 0;
+	for (i=0;i<n;i++)
+		count[lengths[i]]++;
+	count[0] = 0;
+	for (b=1;b<16;b++) {
+		code = (code + count[b-1]) << 1;
+		next[b] = code;
+	}
+	for (i=0;i<n;i++) {
+		int len = lengths[i];
+		unsigned c, r = 0;
+		if (!len) {
+			codes[i] = 0;
+			continue;
+		}
+		c = next[len]++;
+		for (b=0;b<len;b++)
+			r = (r << 1) | ((c >> b) & 1);
+		codes[i] = (unsigned short)r;
+	}
+}
 
-	// Simple RLE compression. We could do better by doing a search
-	// to find matches, but this works pretty well TBH.
-	if (s->prev == v && s->runlen < 115)
-	{
-		s->runlen++;
-	} else {
-		if (s->runlen)
-			endrun(s);
+typedef struct {
+	unsigned short *litlen; // literal byte, or 257+ for a match's length code
+	unsigned short *extra;  // match length extra bits
+	unsigned short *dist;   // match distance, 0 for a literal
+	int count;
+} Tokens;
+
+// Writes the tokens as one block with Huffman codes made for them.
+static void writeBlock(Save *s, Tokens *t, int last)
+{
+	unsigned litFreq[286] = { 0 }, distFreq[30] = { 0 }, clFreq[19] = { 0 };
+	unsigned char lengths[286 + 30], clLengths[19];
+	unsigned short litCodes[286], distCodes[30], clCodes[19];
+	unsigned char rle[286 + 30], rleExtra[286 + 30];
+	int i, nlit, ndist, nrle = 0, ncl;
+
+	for (i=0;i<t->count;i++) {
+		litFreq[t->litlen[i]]++;
+		if (t->dist[i])
+			distFreq[distCode(t->dist[i])]++;
+	}
+	litFreq[256] = 1;
+
+	buildLengths(litFreq, 286, 15, lengths);
+	buildLengths(distFreq, 30, 15, lengths + 286);
+	buildCodes(lengths, 286, litCodes);
+	buildCodes(lengths + 286, 30, distCodes);
+
+	for (nlit=286; nlit>257 && !lengths[nlit-1]; nlit--);
+	for (ndist=30; ndist>1 && !lengths[286+ndist-1]; ndist--);
+	memmove(lengths + nlit, lengths + 286, ndist);
+
+	// Run-length code the code lengths: 16 repeats the last, 17 and 18 repeat zero.
+	for (i=0;i<nlit+ndist;) {
+		int v = lengths[i], run = 1;
+		while (i + run < nlit + ndist && lengths[i+run] == v)
+			run++;
+		if (v == 0 && run >= 11) {
+			if (run > 138) run = 138;
+			rle[nrle] = 18; rleExtra[nrle++] = (unsigned char)(run - 11);
+		} else if (v == 0 && run >= 3) {
+			rle[nrle] = 17; rleExtra[nrle++] = (unsigned char)(run - 3);
+		} else if (v != 0 && run >= 4) {
+			if (run > 7) run = 7;
+			rle[nrle] = (unsigned char)v; rleExtra[nrle++] = 0;
+			rle[nrle] = 16; rleExtra[nrle++] = (unsigned char)(run - 4);
+		} else {
+			run = 1;
+			rle[nrle] = (unsigned char)v; rleExtra[nrle++] = 0;
+		}
+		i += run;
+	}
+	for (i=0;i<nrle;i++)
+		clFreq[rle[i]]++;
+	buildLengths(clFreq, 19, 7, clLengths);
+	buildCodes(clLengths, 19, clCodes);
+	for (ncl=19; ncl>4 && !clLengths[saveLengthOrder[ncl-1]]; ncl--);
+
+	putbits(s, last, 1);
+	putbits(s, 2, 2);
+	putbits(s, nlit - 257, 5);
+	putbits(s, ndist - 1, 5);
+	putbits(s, ncl - 4, 4);
+	for (i=0;i<ncl;i++)
+		putbits(s, clLengths[saveLengthOrder[i]], 3);
+	for (i=0;i<nrle;i++) {
+		putbits(s, clCodes[rle[i]], clLengths[rle[i]]);
+		if (rle[i] == 16) putbits(s, rleExtra[i], 2);
+		if (rle[i] == 17) putbits(s, rleExtra[i], 3);
+		if (rle[i] == 18) putbits(s, rleExtra[i], 7);
+	}
 
-		s->prev = v;
-		s->runlen = 1;
+	for (i=0;i<t->count;i++) {
+		int sym = t->litlen[i];
+		putbits(s, litCodes[sym], lengths[sym]);
+		if (t->dist[i]) {
+			int code = sym - 257, dc = distCode(t->dist[i]);
+			putbits(s, t->extra[i], saveLenExtra[code]);
+			putbits(s, distCodes[dc], lengths[nlit + dc]);
+			putbits(s, t->dist[i] - saveDistBase[dc], saveDistExtra[dc]);
+		}
 	}
+	putbits(s, litCodes[256], lengths[256]);
+	t->count = 0;
 }
 
-static void savePngHeader(Save *s, Tigr *bmp)
+static unsigned load32(const unsigned char *p)
 {
-	fwrite("\211PNG\r\n\032\n", 8, 1, s->out);
-	begin(s, "IHDR", 13);
-	put32(s, bmp->w);
-	put32(s, bmp->h);
-	put(s, 8); // bit depth
-	put(s, 6); // RGBA
-	put(s, 0); // compression (deflate)
-	put(s, 0); // filter (standard)
-	put(s, 0); // interlace off
-	put32(s, ~s->crc);
+	unsigned v;
+	memcpy(&v, p, 4);
+	return v;
 }
 
-static long savePngData(Save *s, Tigr *bmp, long dataPos)
+// Greedy LZ77 that checks one earlier position per hash, like zlib's fastest level,
+// then dynamic Huffman codes per block of tokens.
+static void deflateFast(Save *s, const unsigned char *in, size_t n)
 {
-	int x, y;
-	long dataSize;
-	begin(s, "IDAT", 0);
-	put(s, 0x08); // zlib compression method
-	put(s, 0x1d); // zlib compression flags
-	putbits(s, 3, 3); // zlib last block + fixed dictionary
-	for (y=0;y<bmp->h;y++)
-	{
-		TPixel *row = &bmp->pix[y*bmp->w];
-		TPixel prev = tigrRGBA(0, 0, 0, 0);
+	int *head = (int *)malloc((1 << SAVE_HASH_BITS) * sizeof(int));
+	Tokens t;
+	size_t i = 0;
+	int h;
+
+	t.litlen = (unsigned short *)malloc(SAVE_BLOCK_TOKENS * sizeof(unsigned short));
+	t.extra = (unsigned short *)malloc(SAVE_BLOCK_TOKENS * sizeof(unsigned short));
+	t.dist = (unsigned short *)malloc(SAVE_BLOCK_TOKENS * sizeof(unsigned short));
+	t.count = 0;
+	if (!head || !t.litlen || !t.extra || !t.dist) {
+		s->failed = 1;
+		free(head); free(t.litlen); free(t.extra); free(t.dist);
+		return;
+	}
+	for (h=0;h<(1 << SAVE_HASH_BITS);h++)
+		head[h] = -1;
+
+#define SAVE_HASH(WORD) (((WORD) * 2654435761u) >> (32 - SAVE_HASH_BITS))
+
+	while (i < n) {
+		int len = 0, dist = 0;
+		if (i + 4 <= n) {
+			unsigned word = load32(in + i);
+			int cand;
+			h = SAVE_HASH(word);
+			cand = head[h];
+			head[h] = (int)i;
+			if (cand >= 0 && i - cand <= SAVE_WINDOW && load32(in + cand) == word) {
+				int max = n - i < 258 ? (int)(n - i) : 258;
+				len = 4;
+				while (len < max && in[cand + len] == in[i + len])
+					len++;
+				dist = (int)(i - cand);
+			}
+		}
 
-		encodeByte(s, 1); // sub filter
-		for (x=0;x<bmp->w;x++)
-		{
-			encodeByte(s, row[x].r - prev.r);
-			encodeByte(s, row[x].g - prev.g);
-			encodeByte(s, row[x].b - prev.b);
-			encodeByte(s, row[x].a - prev.a);
-			prev = row[x];
+		if (len) {
+			int code = lengthCode(len), k;
+			t.litlen[t.count] = (unsigned short)(257 + code);
+			t.extra[t.count] = (unsigned short)(len - saveLenBase[code]);
+			t.dist[t.count++] = (unsigned short)dist;
+			// Short matches are common in flat images; remembering their insides finds more.
+			if (len <= 32)
+				for (k=1;k<len && i + k + 4 <= n;k++)
+					head[SAVE_HASH(load32(in + i + k))] = (int)(i + k);
+			i += len;
+		} else {
+			t.litlen[t.count] = in[i++];
+			t.dist[t.count++] = 0;
 		}
+
+		if (t.count == SAVE_BLOCK_TOKENS)
+			writeBlock(s, &t, 0);
 	}
-	endrun(s);
-	literal(s, 256); // terminator
-	while (s->bits != 0x80)
-		putbits(s, 0, 1);
-	put32(s, s->adler);
-	dataSize = (ftell(s->out) - dataPos) - 8;
-	put32(s, ~s->crc);
-	return dataSize;
+	writeBlock(s, &t, 1);
+
+#undef SAVE_HASH
+
+	free(head);
+	free(t.litlen);
+	free(t.extra);
+	free(t.dist);
 }
 
-int tigrSaveImage(const char *fileName, Tigr *bmp)
+// Stored blocks: no compression at all, just the length of each block.
+static void deflateStored(Save *s, const unsigned char *in, size_t n)
 {
-	Save s;
-	long dataPos, dataSize, err;
-	
-	// TODO - unicode?
-	FILE *out = fopen(fileName, "wb");
-	if (!out)
-		return 1;
+	reserve(s, n + (n / 65535 + 1) * 5);
+	do {
+		unsigned len = n < 65535 ? (unsigned)n : 65535;
+		putbits(s, len == n, 1);
+		putbits(s, 0, 2);
+		flushbits(s);
+		put(s, len & 0xff);
+		put(s, len >> 8);
+		put(s, ~len & 0xff);
+		put(s, (~len >> 8) & 0xff);
+		putBytes(s, in, len);
+		in += len;
+		n -= len;
+	} while (n);
+}
+
+static void putChunk(Save *s, unsigned crcTable[4][256], const char *id, const unsigned char *data, size_t len)
+{
+	size_t start;
+	put32(s, (unsigned)len);
+	start = s->len;
+	putBytes(s, id, 4);
+	putBytes(s, data, len);
+	if (!s->failed)
+		put32(s, crc32(crcTable, s->data + start, len + 4));
+}
+
+static void *encodePng(Tigr *bmp, int level, int *length)
+{
+	Save s, z;
+	unsigned crcTable[4][256];
+	unsigned char header[13];
+	unsigned char *raw;
+	size_t rawSize;
+
+	raw = filterImage(bmp, level > 0, &rawSize);
+	if (!raw)
+		return NULL;
 
-	s.out = out;
-	s.adler = 1;
-	s.bits = 0x80;
-	s.prev = 0xffff;
-	s.runlen = 0;
+	// The zlib stream: header, deflate data, checksum.
+	memset(&z, 0, sizeof(z));
+	put(&z, 0x78);
+	put(&z, 0x01);
+	if (level > 0)
+		deflateFast(&z, raw, rawSize);
+	else
+		deflateStored(&z, raw, rawSize);
+	flushbits(&z);
+	put32(&z, adler32(raw, rawSize));
+	free(raw);
+
+	header[0] = bmp->w >> 24; header[1] = bmp->w >> 16; header[2] = bmp->w >> 8; header[3] = bmp->w;
+	header[4] = bmp->h >> 24; header[5] = bmp->h >> 16; header[6] = bmp->h >> 8; header[7] = bmp->h;
+	header[8] = 8;  // bit depth
+	header[9] = 6;  // RGBA
+	header[10] = 0; // compression (deflate)
+	header[11] = 0; // filter (standard)
+	header[12] = 0; // interlace off
+
+	makeCrcTable(crcTable);
+	memset(&s, 0, sizeof(s));
+	reserve(&s, z.len + 64);
+	putBytes(&s, "\211PNG\r\n\032\n", 8);
+	putChunk(&s, crcTable, "IHDR", header, 13);
+	putChunk(&s, crcTable, "IDAT", z.data, z.len);
+	putChunk(&s, crcTable, "IEND", NULL, 0);
+
+	free(z.data);
+	if (s.failed || z.failed) {
+		free(s.data);
+		errno = ENOMEM;
+		return NULL;
+	}
+	*length = (int)s.len;
+	return s.data;
+}
+
+void *tigrEncodeImage(Tigr *bmp, int level, int *length)
+{
+	return encodePng(bmp, level, length);
+}
 
-	savePngHeader(&s, bmp);
-	dataPos = ftell(s.out);
-	dataSize = savePngData(&s, bmp, dataPos);
+int tigrSaveImageLevel(const char *fileName, Tigr *bmp, int level)
+{
+	int length, ok;
+	void *data;
+	FILE *out;
 
-	// End chunk.
-	begin(&s, "IEND", 0);
-	put32(&s, ~s.crc);
+	data = encodePng(bmp, level, &length);
+	if (!data)
+		return 0;
 
-	// Write back payload size.
-	fseek(out, dataPos, SEEK_SET);
-	put32(&s, dataSize);
+	// TODO - unicode?
+	out = fopen(fileName, "wb");
+	if (!out) {
+		free(data);
+		return 0;
+	}
+	ok = fwrite(data, 1, length, out) == (size_t)length;
+	ok = (fclose(out) == 0) && ok;
+	free(data);
+	return ok;
+}
 
-	err = ferror(out);
-	fclose(out);
-	return !err;
+int tigrSaveImage(const char *fileName, Tigr *bmp)
+{
+	return tigrSaveImageLevel(fileName, bmp, 1);
 }
 
 //////// End of inlined file: tigr_savepng.c ////////
@@ -1829,6 +2817,8 @@ void tigrUpdate(Tigr *bmp)
 		TranslateMessage(&msg);
 		DispatchMessage(&msg);
 	}
+
+	tigrQueueInputChanges(bmp);
 }
 
 typedef BOOL (APIENTRY *PFNWGLSWAPINTERVALFARPROC_)( int );
@@ -2131,6 +3121,18 @@ Tigr *tigrWindow(int w, int h, const char *title, int flags)
 	return bmp;
 }
 
+int tigrSetSwapInterval(Tigr *bmp, int interval)
+{
+	int ok = 0;
+	// Negative intervals need WGL_EXT_swap_control_tear; the call fails without it
+	if (wglSwapIntervalEXT_ && !tigrGAPIBegin(bmp))
+	{
+		ok = wglSwapIntervalEXT_(interval) ? 1 : 0;
+		tigrGAPIEnd(bmp);
+	}
+	return ok;
+}
+
 void tigrFree(Tigr *bmp)
 {
 	if (bmp->handle)
@@ -2152,7 +3154,7 @@ void tigrFree(Tigr *bmp)
 		free(win->wtitle);
 		tigrFree(win->widgets);
 	}
-	free(bmp->pix);
+	poolRelease(bmp->pix);
 	free(bmp);
 }
 
@@ -2311,6 +3313,16 @@ int tigrKeyHeld(Tigr *bmp, int key)
 	return win->keys[k];
 }
 
+int tigrKeyUp(Tigr *bmp, int key)
+{
+	TigrInternal *win;
+	int k = tigrWinVK(key);
+	if (GetFocus() != bmp->handle)
+		return 0;
+	win = tigrInternal(bmp);
+	return !win->keys[k] && win->prev[k];
+}
+
 int tigrReadChar(Tigr *bmp)
 {
 	TigrInternal *win = tigrInternal(bmp);
@@ -2791,7 +3803,7 @@ void tigrFree(Tigr* bmp) {
         objc_msgSend_void((id)win->gl.glContext, sel_registerName("release"));
         objc_msgSend_void(window, sel_registerName("release"));
     }
-    free(bmp->pix);
+    poolRelease(bmp->pix);
     free(bmp);
 }
 
@@ -3283,6 +4295,8 @@ void tigrUpdate(Tigr* bmp) {
     tigrGAPIPresent(bmp, windowSize.width, windowSize.height);
     objc_msgSend_void(openGLContext, sel_registerName("flushBuffer"));
     tigrGAPIEnd(bmp);
+
+    tigrQueueInputChanges(bmp);
 }
 
 int tigrGAPIBegin(Tigr* bmp) {
@@ -3297,6 +4311,18 @@ int tigrGAPIEnd(Tigr* bmp) {
     return 0;
 }
 
+int tigrSetSwapInterval(Tigr* bmp, int interval) {
+    TigrInternal* win = tigrInternal(bmp);
+    // NSOpenGLContextParameterSwapInterval; there is no late-swap tearing
+    int value = interval;
+    if (interval < 0) {
+        return 0;
+    }
+    ((void (*)(id, SEL, const int*, NSUInteger))objc_msgSend)(
+        (id)win->gl.glContext, sel_registerName("setValues:forParameter:"), &value, 222);
+    return 1;
+}
+
 int tigrClosed(Tigr* bmp) {
     return (terminated || _tigrCocoaIsWindowClosed((id)bmp->handle)) ? 1 : 0;
 }
@@ -3366,6 +4392,13 @@ int tigrKeyHeld(Tigr* bmp, int key) {
     return win->keys[key];
 }
 
+int tigrKeyUp(Tigr* bmp, int key) {
+    TigrInternal* win;
+    assert(key < 256);
+    win = tigrInternal(bmp);
+    return !win->keys[key] && win->prev[key];
+}
+
 int tigrReadChar(Tigr* bmp) {
     TigrInternal* win = tigrInternal(bmp);
     int c = win->lastChar;
@@ -3538,26 +4571,39 @@ static int hasGLXExtension(Display* display, const char* wanted) {
 	return found != 0;
 }
 
-static void setupVSync(Display* display, Window win) {
+static int setupVSync(Display* display, Window win, int interval) {
 	if (hasGLXExtension(display, "GLX_EXT_swap_control")) {
 		PFNGLXSWAPINTERVALEXTPROC glXSwapIntervalEXT=
 			(PFNGLXSWAPINTERVALEXTPROC)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalEXT");
-		if (glXSwapIntervalEXT) {
-			glXSwapIntervalEXT(display, win, 1);
+		// Negative intervals (late swaps tear) need the tear extension on top
+		if (glXSwapIntervalEXT && (interval >= 0 || hasGLXExtension(display, "GLX_EXT_swap_control_tear"))) {
+			glXSwapIntervalEXT(display, win, interval);
+			return 1;
 		}
 	} else if (hasGLXExtension(display, "GLX_MESA_swap_control")) {
 		PFNGLXSWAPINTERVALMESAPROC glXSwapIntervalMESA =
 			(PFNGLXSWAPINTERVALMESAPROC)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalMESA");
-		if (glXSwapIntervalMESA) {
-			glXSwapIntervalMESA(1);
+		if (glXSwapIntervalMESA && interval >= 0) {
+			return glXSwapIntervalMESA(interval) == 0;
 		}
 	} else if (hasGLXExtension(display, "GLX_SGI_swap_control")) {
 		PFNGLXSWAPINTERVALSGIPROC glXSwapIntervalSGI =
 			(PFNGLXSWAPINTERVALSGIPROC)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalSGI");
-		if (glXSwapIntervalSGI) {
-			glXSwapIntervalSGI(1);
+		// SGI can't turn vsync off
+		if (glXSwapIntervalSGI && interval > 0) {
+			return glXSwapIntervalSGI(interval) == 0;
 		}
 	}
+	return 0;
+}
+
+int tigrSetSwapInterval(Tigr *bmp, int interval) {
+	TigrInternal *win = tigrInternal(bmp);
+	if (!win->win) {
+		return 0;
+	}
+	glXMakeCurrent(win->dpy, win->win, win->glc);
+	return setupVSync(win->dpy, win->win, interval);
 }
 
 static void tigrHideCursor(TigrInternal *win) {
@@ -3612,7 +4658,8 @@ Tigr *tigrWindow(int w, int h, const char *title, int flags) {
 
 	cmap = XCreateColormap(dpy, root, vi->visual, AllocNone);
 	swa.colormap = cmap;
-	swa.event_mask = StructureNotifyMask;
+	swa.event_mask = StructureNotifyMask | FocusChangeMask | KeyPressMask | KeyReleaseMask |
+		ButtonPressMask | ButtonReleaseMask | PointerMotionMask;
 
 	// Create window of wanted size
 	xwin = XCreateWindow(dpy, root, 0, 0, w * scale, h * scale, 0, vi->depth, InputOutput, vi->visual, CWColormap | CWEventMask, &swa);
@@ -3677,7 +4724,7 @@ Tigr *tigrWindow(int w, int h, const char *title, int flags) {
 	glc = glXCreateContextAttribsARB(dpy, fbConfig, NULL, GL_TRUE, contextAttributes);
 	glXMakeCurrent(dpy, xwin, glc);
 
-	setupVSync(dpy, xwin);
+	setupVSync(dpy, xwin, 1);
 
 	bmp = tigrBitmap2(w, h, sizeof(TigrInternal));
 	bmp->handle = (void*)xwin;
@@ -3692,6 +4739,12 @@ Tigr *tigrWindow(int w, int h, const char *title, int flags) {
 	win->closed = 0;
 	win->scale = scale;
 
+	// Kept up to date by ConfigureNotify events
+	XWindowAttributes wa;
+	XGetWindowAttributes(dpy, xwin, &wa);
+	win->width = wa.width;
+	win->height = wa.height;
+
 	win->lastChar = 0;
 	win->flags = flags;
 	win->p1 = win->p2 = win->p3 = 0;
@@ -3727,8 +4780,8 @@ int tigrGAPIBegin(Tigr *bmp) {
 }
 
 int tigrGAPIEnd(Tigr *bmp) {
-	(void)bmp;
-	return glXMakeCurrent(NULL, 0, 0) ? 0 : -1;
+	TigrInternal *win = tigrInternal(bmp);
+	return glXMakeCurrent(win->dpy, None, NULL) ? 0 : -1;
 }
 
 int tigrKeyDown(Tigr *bmp, int key) {
@@ -3746,6 +4799,14 @@ int tigrKeyHeld(Tigr *bmp, int key)
 	return win->keys[key];
 }
 
+int tigrKeyUp(Tigr *bmp, int key)
+{
+	TigrInternal *win;
+	assert(key < 256);
+	win = tigrInternal(bmp);
+	return !win->keys[key] && win->prev[key];
+}
+
 int tigrReadChar(Tigr *bmp)
 {
 	TigrInternal *win = tigrInternal(bmp);
@@ -3847,121 +4908,150 @@ static void tigrUpdateModifiers(TigrInternal *win) {
     win->keys[TK_ALT] = win->keys[TK_LALT] || win->keys[TK_RALT];
 }
 
-static void tigrInterpretChar(TigrInternal* win, Window root, unsigned int keycode, unsigned int mask) {
-	XKeyEvent event;
-	memset(&event, 0, sizeof(event));
-	event.type = KeyPress;
-	event.display = win->dpy;
-	event.root = root;
-	event.window = win->win;
-	event.state = mask;
-	event.keycode = keycode;
+static void tigrInterpretChar(TigrInternal* win, XKeyEvent *event) {
 	char inputTextUTF8[10];
 	Status status = 0;
-	Xutf8LookupString(win->ic, &event, inputTextUTF8, sizeof(inputTextUTF8), NULL, &status);
+	Xutf8LookupString(win->ic, event, inputTextUTF8, sizeof(inputTextUTF8), NULL, &status);
 
 	if(status == XLookupChars) {
 		tigrDecodeUTF8(inputTextUTF8, &win->lastChar);
 	}
 }
 
-static void tigrProcessInput(TigrInternal* win, int winWidth, int winHeight) {
-	{
-		Window focused;
-		int revertTo;
-		XGetInputFocus(win->dpy, &focused, &revertTo);
-
-		if (win->win != focused) {
-			return;
-		}
+static int tigrButtonFromX11(unsigned int button) {
+	switch(button) {
+		case Button1: return 1;
+		case Button3: return 2;
+		case Button2: return 4;
 	}
+	return 0;
+}
+
+static void tigrSetKey(TigrInternal* win, int key, int down, double time) {
+	if (key && win->keysDown[key] != down) {
+		win->keysDown[key] = down;
+		tigrQueueEvent(win, down ? TIGR_EVENT_KEY_DOWN : TIGR_EVENT_KEY_UP, win->mouseX, win->mouseY, win->mouseButtons, key, time);
 
-	Window root;
-	Window child;
-	int rootX;
-	int rootY;
-	int winX;
-	int winY;
-	unsigned int mask;
-
-	if (XQueryPointer(win->dpy, win->win, &root, &child, &rootX, &rootY, &winX, &winY, &mask)) {
-		static unsigned int prevButtons;
-		unsigned int buttons = mask & (Button1Mask | Button2Mask | Button3Mask);
-
-		win->mouseX = (winX - win->pos[0]) / win->scale;
-		win->mouseY = (winY - win->pos[1]) / win->scale;
-
-		if (buttons != prevButtons && (winX > 0 && winX < winWidth) && (winY > 0 && winY < winHeight)) {
-			win->mouseButtons = 
-				(buttons & Button1Mask) ? 1 : 0 |
-				(buttons & Button3Mask) ? 2 : 0 |
-				(buttons & Button2Mask) ? 4 : 0 ;
+		// A key released in the frame it was pressed stays held until the next tigrUpdate,
+		// so tigrKeyDown and tigrKeyUp each still see it for one frame
+		if (down || win->prev[key]) {
+			win->keys[key] = down;
+			tigrUpdateModifiers(win);
 		}
-		prevButtons = buttons;
 	}
+}
 
-	static char prevKeys[32];
-	char keys[32];
-	XQueryKeymap(win->dpy, keys);
-	for (int i = 0; i < 32; i++) {
-		char thisBlock = keys[i];
-		char prevBlock = prevKeys[i];
-		if (thisBlock != prevBlock) {
-			for (int j = 0; j < 8; j++) {
-				int thisBit = thisBlock & 1;
-				int prevBit = prevBlock & 1;
-				thisBlock >>= 1;
-				prevBlock >>= 1;
-				if (thisBit != prevBit) {
-					int keyCode = 8 * i + j;
-					KeySym keySym = XkbKeycodeToKeysym(win->dpy, keyCode, 0, 0);
-					if (keySym != NoSymbol) {
-						int key = tigrKeyFromX11(keySym);
-						win->keys[key] = thisBit;
-						tigrUpdateModifiers(win);
-
-						if (thisBit) {
-							tigrInterpretChar(win, root, keyCode, mask);
-						}
+// X stamps events with the server's millisecond clock, which for a local server is CLOCK_MONOTONIC cut to 32 bits.
+// Puts such a stamp back on tigrClock(), or uses the current time if the server's clock turns out to be something else.
+static double tigrFromXTime(Time time) {
+	double now = tigrClock();
+	unsigned int age = (unsigned int)(unsigned long long)(now * 1000.0) - (unsigned int)time;
+	return age < 10000 ? now - age / 1000.0 : now;
+}
+
+// Everything the window selected in tigrWindow except StructureNotifyMask, which is also read there
+#define INPUT_EVENT_MASK (FocusChangeMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask)
+
+// Reads the events X has already sent, so input costs no round trips to the server.
+static void tigrProcessInput(TigrInternal* win) {
+	XEvent event;
+
+	while (XCheckWindowEvent(win->dpy, win->win, INPUT_EVENT_MASK | StructureNotifyMask, &event)) {
+		switch (event.type) {
+			case ConfigureNotify:
+				win->width = event.xconfigure.width;
+				win->height = event.xconfigure.height;
+				break;
+
+			case MotionNotify:
+				win->mouseX = (event.xmotion.x - win->pos[0]) / win->scale;
+				win->mouseY = (event.xmotion.y - win->pos[1]) / win->scale;
+				tigrQueueEvent(win, TIGR_EVENT_MOUSE_MOVE, win->mouseX, win->mouseY, win->mouseButtons, 0, tigrFromXTime(event.xmotion.time));
+				break;
+
+			case ButtonPress:
+			case ButtonRelease: {
+				int button = tigrButtonFromX11(event.xbutton.button);
+				if (!button) {
+					break; // Scroll wheel
+				}
+				win->mouseX = (event.xbutton.x - win->pos[0]) / win->scale;
+				win->mouseY = (event.xbutton.y - win->pos[1]) / win->scale;
+				if (event.type == ButtonPress) {
+					win->mouseButtons |= button;
+				} else {
+					win->mouseButtons &= ~button;
+				}
+				tigrQueueEvent(win, event.type == ButtonPress ? TIGR_EVENT_MOUSE_DOWN : TIGR_EVENT_MOUSE_UP,
+					win->mouseX, win->mouseY, win->mouseButtons, button, tigrFromXTime(event.xbutton.time));
+				break;
+			}
+
+			case KeyPress: {
+				KeySym keySym = XkbKeycodeToKeysym(win->dpy, event.xkey.keycode, 0, 0);
+				if (keySym != NoSymbol) {
+					tigrSetKey(win, tigrKeyFromX11(keySym), 1, tigrFromXTime(event.xkey.time));
+				}
+				tigrInterpretChar(win, &event.xkey);
+				break;
+			}
+
+			case KeyRelease: {
+				// Auto-repeat sends a release immediately followed by a press with the same time; the key is still held
+				if (XEventsQueued(win->dpy, QueuedAfterReading)) {
+					XEvent next;
+					XPeekEvent(win->dpy, &next);
+					if (next.type == KeyPress && next.xkey.window == win->win &&
+						next.xkey.keycode == event.xkey.keycode && next.xkey.time == event.xkey.time) {
+						break;
 					}
 				}
+				KeySym keySym = XkbKeycodeToKeysym(win->dpy, event.xkey.keycode, 0, 0);
+				if (keySym != NoSymbol) {
+					tigrSetKey(win, tigrKeyFromX11(keySym), 0, tigrFromXTime(event.xkey.time));
+				}
+				break;
 			}
+
+			case FocusOut:
+				// Releases are not sent to a window without focus, so let go of everything now
+				for (int key = 1; key < 256; key++) {
+					tigrSetKey(win, key, 0, tigrClock());
+				}
+				break;
 		}
 	}
-	memcpy(prevKeys, keys, 32);
 
-	XEvent event;
 	while (XCheckTypedWindowEvent(win->dpy, win->win, ClientMessage, &event)) {
 		if(event.xclient.data.l[0] == wmDeleteMessage) {
 			glXMakeCurrent(win->dpy, None, NULL);
 			glXDestroyContext(win->dpy, win->glc);
 			XDestroyWindow(win->dpy, win->win);
 			win->win = 0;
+			return;
 		}
 	}
 	XFlush(win->dpy);
 }
 
 void tigrUpdate(Tigr *bmp) {
-	XWindowAttributes gwa;
-
 	TigrInternal *win = tigrInternal(bmp);
 
 	memcpy(win->prev, win->keys, 256);
-
-	XGetWindowAttributes(win->dpy, win->win, &gwa);
+	memcpy(win->keys, win->keysDown, 256);
+	tigrUpdateModifiers(win);
 
 	if (win->flags & TIGR_AUTO)
-		tigrResize(bmp, gwa.width / win->scale, gwa.height / win->scale);
+		tigrResize(bmp, win->width / win->scale, win->height / win->scale);
 	else
-		win->scale = tigrEnforceScale(tigrCalcScale(bmp->w, bmp->h, gwa.width, gwa.height), win->flags);
+		win->scale = tigrEnforceScale(tigrCalcScale(bmp->w, bmp->h, win->width, win->height), win->flags);
 
-	tigrPosition(bmp, win->scale, gwa.width, gwa.height, win->pos);
+	tigrPosition(bmp, win->scale, win->width, win->height, win->pos);
 	glXMakeCurrent(win->dpy, win->win, win->glc);
-	tigrGAPIPresent(bmp, gwa.width, gwa.height);
+	tigrGAPIPresent(bmp, win->width, win->height);
 	glXSwapBuffers(win->dpy, win->win);
 
-	tigrProcessInput(win, gwa.width, gwa.height);
+	tigrProcessInput(win);
 }
 
 void tigrFree(Tigr *bmp) {
@@ -3975,7 +5065,7 @@ void tigrFree(Tigr *bmp) {
         	win->win = 0;
         }
 	}
-	free(bmp->pix);
+	poolRelease(bmp->pix);
 	free(bmp);
 }
 
@@ -4385,6 +5475,15 @@ int tigrGAPIEnd(Tigr* bmp) {
     return 0;
 }
 
+int tigrSetSwapInterval(Tigr* bmp, int interval) {
+    (void)bmp;
+    // EGL has no late-swap tearing
+    if (interval < 0) {
+        return 0;
+    }
+    return eglSwapInterval(gState.display, interval) == EGL_TRUE;
+}
+
 int tigrKeyDown(Tigr* bmp, int key) {
     TigrInternal* win;
     assert(key < 256);
@@ -4399,6 +5498,13 @@ int tigrKeyHeld(Tigr* bmp, int key) {
     return win->keys[key];
 }
 
+int tigrKeyUp(Tigr* bmp, int key) {
+    TigrInternal* win;
+    assert(key < 256);
+    win = tigrInternal(bmp);
+    return !win->keys[key] && win->prev[key];
+}
+
 int tigrReadChar(Tigr* bmp) {
     TigrInternal* win = tigrInternal(bmp);
     int c = win->lastChar;
@@ -4462,6 +5568,8 @@ void tigrUpdate(Tigr* bmp) {
     tigrGAPIPresent(bmp, gState.screenW, gState.screenH);
     android_swap(gState.display, gState.surface);
     tigrGAPIEnd(bmp);
+
+    tigrQueueInputChanges(bmp);
 }
 
 void tigrFree(Tigr* bmp) {
@@ -4479,7 +5587,7 @@ void tigrFree(Tigr* bmp) {
 
         win->context = EGL_NO_CONTEXT;
     }
-    free(bmp->pix);
+    poolRelease(bmp->pix);
     free(bmp);
 }
 
@@ -4579,6 +5687,13 @@ typedef ptrdiff_t GLsizeiptr;
 #define GL_FRAGMENT_SHADER                0x8B30
 #define GL_BGRA                           0x80E1
 #define GL_TEXTURE0                       0x84C0
+#define GL_PIXEL_UNPACK_BUFFER            0x88EC
+#define GL_STREAM_DRAW                    0x88E0
+#define GL_MAP_WRITE_BIT                  0x0002
+#define GL_MAP_INVALIDATE_BUFFER_BIT      0x0008
+#define GL_MAJOR_VERSION                  0x821B
+#define GL_MINOR_VERSION                  0x821C
+typedef ptrdiff_t GLintptr;
 typedef void (APIENTRYP PFNGLGENVERTEXARRAYSPROC) (GLsizei n, GLuint *arrays);
 typedef void (APIENTRYP PFNGLGENBUFFERSARBPROC) (GLsizei n, GLuint *buffers);
 typedef void (APIENTRYP PFNGLBINDBUFFERPROC) (GLenum target, GLuint buffer);
@@ -4604,6 +5719,10 @@ typedef GLint (APIENTRYP PFNGLGETUNIFORMLOCATIONPROC) (GLuint program, const GLc
 typedef void (APIENTRYP PFNGLUNIFORM4FPROC) (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
 typedef void (APIENTRYP PFNGLUNIFORMMATRIX4FVPROC) (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
 typedef void (APIENTRYP PFNGLACTIVETEXTUREPROC) (GLenum texture);
+typedef void *(APIENTRYP PFNGLMAPBUFFERRANGEPROC) (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLboolean (APIENTRYP PFNGLUNMAPBUFFERPROC) (GLenum target);
+typedef void (APIENTRYP PFNGLDELETEBUFFERSPROC) (GLsizei n, const GLuint *buffers);
+typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC) (GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
 #define WGL_DRAW_TO_WINDOW_ARB            0x2001
 #define WGL_SUPPORT_OPENGL_ARB            0x2010
 #define WGL_DOUBLE_BUFFER_ARB             0x2011
@@ -4644,6 +5763,10 @@ PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation;
 PFNGLUNIFORM4FPROC glUniform4f;
 PFNGLUNIFORMMATRIX4FVPROC glUniformMatrix4fv;
 PFNGLACTIVETEXTUREPROC glActiveTexture;
+PFNGLMAPBUFFERRANGEPROC glMapBufferRange;
+PFNGLUNMAPBUFFERPROC glUnmapBuffer;
+PFNGLDELETEBUFFERSPROC glDeleteBuffers;
+PFNGLTEXSTORAGE2DPROC glTexStorage2D;
 int tigrGL11Init(Tigr *bmp)
 {
 	int pixel_format;
@@ -4706,6 +5829,10 @@ int tigrGL33Init(Tigr *bmp)
 	glUniform4f = (PFNGLUNIFORM4FPROC)wglGetProcAddress("glUniform4f");
 	glUniformMatrix4fv = (PFNGLUNIFORMMATRIX4FVPROC)wglGetProcAddress("glUniformMatrix4fv");
 	glActiveTexture = (PFNGLACTIVETEXTUREPROC)wglGetProcAddress("glActiveTexture");
+	glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)wglGetProcAddress("glMapBufferRange");
+	glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)wglGetProcAddress("glUnmapBuffer");
+	glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)wglGetProcAddress("glDeleteBuffers");
+	glTexStorage2D = (PFNGLTEXSTORAGE2DPROC)wglGetProcAddress("glTexStorage2D");
 
 	if(!wglChoosePixelFormat || !wglCreateContextAttribs) {tigrError(bmp, "Cannot create OpenGL context.\n"); return -1;}
 	const int attribList[] =
@@ -4803,6 +5930,15 @@ void tigrCreateShaderProgram(GLStuff* gl, const char* fxSource, int fxSize) {
 	gl->uniform_parameters = glGetUniformLocation(gl->program, "parameters");
 }
 
+static void tigrGAPISetupTexture(GLStuff *gl, GLuint tex)
+{
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl->gl_legacy ? GL_NEAREST : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl->gl_legacy ? GL_NEAREST : GL_LINEAR);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+}
+
 void tigrGAPICreate(Tigr *bmp)
 {
 	TigrInternal *win = tigrInternal(bmp);
@@ -4847,13 +5983,25 @@ void tigrGAPICreate(Tigr *bmp)
 	}
 	glGenTextures(2, gl->tex);
 	for(int i = 0; i < 2; ++i) {
-		glBindTexture(GL_TEXTURE_2D, gl->tex[i]);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl->gl_legacy ? GL_NEAREST : GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl->gl_legacy ? GL_NEAREST : GL_LINEAR);
-		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		tigrGAPISetupTexture(gl, gl->tex[i]);
 	}
 
+	// Immutable texture storage needs GL 4.2 or GLES 3
+	gl->texStorage = 0;
+	#if __ANDROID__
+	gl->texStorage = 1;
+	#elif !__APPLE__
+	if(!gl->gl_legacy) {
+		GLint major = 0, minor = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		gl->texStorage = (major > 4 || (major == 4 && minor >= 2));
+		#ifdef _WIN32
+		gl->texStorage = gl->texStorage && glTexStorage2D && glMapBufferRange && glUnmapBuffer;
+		#endif
+	}
+	#endif
+
 	tigrCheckGLError("initialization");
 }
 
@@ -4867,6 +6015,8 @@ void tigrGAPIDestroy(Tigr *bmp)
 	if(!gl->gl_legacy)
 	{
 		glDeleteTextures(2, gl->tex);
+		if(gl->pbo[0])
+			glDeleteBuffers(2, gl->pbo);
 		glDeleteProgram(gl->program);
 	}
 
@@ -4875,10 +6025,67 @@ void tigrGAPIDestroy(Tigr *bmp)
 	if(tigrGAPIEnd(bmp) < 0) {tigrError(bmp, "Cannot deactivate OpenGL context.\n"); return;}
 }
 
-void tigrGAPIDraw(int legacy, GLuint uniform_model, GLuint tex, Tigr *bmp, int x1, int y1, int x2, int y2)
+// Copies the window's bitmap into tex[0].
+// The texture's storage is only allocated when the bitmap changes size. Each frame goes through one
+// of two pixel buffers, so the driver can still be reading the last frame while this one is written.
+static void tigrGAPIUpload(GLStuff *gl, Tigr *bmp)
+{
+	GLsizeiptr size = (GLsizeiptr)bmp->w * bmp->h * sizeof(TPixel);
+	void *dst = NULL;
+
+	glBindTexture(GL_TEXTURE_2D, gl->tex[0]);
+	if(gl->gl_legacy) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bmp->w, bmp->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, bmp->pix);
+		return;
+	}
+
+	if(gl->texW != bmp->w || gl->texH != bmp->h) {
+		if(gl->texW && gl->texStorage) {
+			// Immutable storage can't be resized, so start over with a new texture
+			glDeleteTextures(1, &gl->tex[0]);
+			glGenTextures(1, &gl->tex[0]);
+			tigrGAPISetupTexture(gl, gl->tex[0]);
+		}
+		#if !__APPLE__
+		if(gl->texStorage)
+			glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, bmp->w, bmp->h);
+		else
+		#endif
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bmp->w, bmp->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+		if(!gl->pbo[0])
+			glGenBuffers(2, gl->pbo);
+		for(int i = 0; i < 2; ++i) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo[i]);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		}
+		gl->texW = bmp->w;
+		gl->texH = bmp->h;
+	}
+
+	gl->pboIndex ^= 1;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo[gl->pboIndex]);
+	#ifndef _WIN32
+	dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	#else
+	if(glMapBufferRange)
+		dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	#endif
+	if(dst) {
+		memcpy(dst, bmp->pix, size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bmp->w, bmp->h, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// Mapping failed: upload straight from the bitmap
+	if(!dst)
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bmp->w, bmp->h, GL_RGBA, GL_UNSIGNED_BYTE, bmp->pix);
+}
+
+void tigrGAPIDraw(int legacy, GLuint uniform_model, GLuint tex, int x1, int y1, int x2, int y2)
 {
 	glBindTexture(GL_TEXTURE_2D, tex);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bmp->w, bmp->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, bmp->pix);
 
 	if(!legacy)
 	{
@@ -4962,13 +6169,16 @@ void tigrGAPIPresent(Tigr *bmp, int w, int h)
 	{
 		glDisable(GL_BLEND);
 	}
-	tigrGAPIDraw(gl->gl_legacy, gl->uniform_model, gl->tex[0], bmp, win->pos[0], win->pos[1], win->pos[2], win->pos[3]);
+	tigrGAPIUpload(gl, bmp);
+	tigrGAPIDraw(gl->gl_legacy, gl->uniform_model, gl->tex[0], win->pos[0], win->pos[1], win->pos[2], win->pos[3]);
 
 	if (win->widgetsScale > 0)
 	{
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		tigrGAPIDraw(gl->gl_legacy, gl->uniform_model, gl->tex[1], win->widgets,
+		glBindTexture(GL_TEXTURE_2D, gl->tex[1]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, win->widgets->w, win->widgets->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, win->widgets->pix);
+		tigrGAPIDraw(gl->gl_legacy, gl->uniform_model, gl->tex[1],
 			(int)(w - win->widgets->w * win->widgetsScale), 0,		
 			w, (int)(win->widgets->h * win->widgetsScale));
 	}
@@ -5100,6 +6310,21 @@ int tigrBeginOpenGL(Tigr* bmp) {
 #endif
 }
 
+void tigrEndOpenGL(Tigr* bmp) {
+#ifdef TIGR_GAPI_GL
+    tigrGAPIEnd(bmp);
+#endif
+}
+
+void tigrWaitPresent(Tigr* bmp) {
+#ifdef TIGR_GAPI_GL
+    if (tigrGAPIBegin(bmp) == 0) {
+        glFinish();
+        tigrGAPIEnd(bmp);
+    }
+#endif
+}
+
 void tigrSetPostShader(Tigr *bmp, const char* code, int size) {
 #ifdef TIGR_GAPI_GL
     TigrInternal* win = tigrInternal(bmp);
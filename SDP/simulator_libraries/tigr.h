@@ -62,16 +62,49 @@ Tigr *tigrBitmap(int w, int h);
 // Deletes a window/bitmap.
 void tigrFree(Tigr *bmp);
 
+// Pixel buffers are kept in a pool when freed and handed out again to bitmaps of
+// about the same size (within a quarter), so images that come and go don't
+// reach malloc each time. Buffers are 64-byte aligned. The pool keeps at most
+// TIGR_POOL_LIMIT bytes (32 MB unless defined otherwise when building tigr.c).
+// The pool takes no lock: make and free bitmaps on one thread.
+typedef struct TigrPoolStats {
+    long allocations;   // pixel buffers handed out
+    long reused;        // of those, how many came from the pool instead of malloc
+    long inUse;         // buffers handed out and not freed yet
+    long pooled;        // buffers waiting in the pool
+    long pooledBytes;   // bytes those take up
+} TigrPoolStats;
+
+// Reads the pool's counts.
+void tigrPoolStats(TigrPoolStats *stats);
+
+// Gives every buffer waiting in the pool back to the system.
+void tigrPoolTrim(void);
+
 // Returns non-zero if the user requested to close a window.
 int tigrClosed(Tigr *bmp);
 
 // Displays a window's contents on-screen.
 void tigrUpdate(Tigr *bmp);
 
+// Sets how many vertical blanks tigrUpdate waits for before showing a frame:
+// 1 = vsync (default), 0 = don't wait (may tear), -1 = vsync unless the frame
+// is late, in which case it is shown at once (adaptive, may tear).
+// Returns non-zero if the platform supports the interval.
+int tigrSetSwapInterval(Tigr *bmp, int interval);
+
+// Waits until the GPU has finished the frame sent by the last tigrUpdate,
+// i.e. until it has been handed to the display. Blocks, so only use it for measuring.
+void tigrWaitPresent(Tigr *bmp);
+
 // Called before doing direct OpenGL calls and before tigrUpdate.
 // Returns non-zero if OpenGL is available.
 int tigrBeginOpenGL(Tigr *bmp);
 
+// Releases a window's OpenGL context from the calling thread, so that another
+// thread can call tigrUpdate. Only Linux supports presenting from another thread.
+void tigrEndOpenGL(Tigr *bmp);
+
 // Sets post shader for a window.
 // This replaces the built-in post-FX shader.
 void tigrSetPostShader(Tigr *bmp, const char* code, int size);
@@ -118,6 +151,19 @@ void tigrBlitAlpha(Tigr *dest, Tigr *src, int dx, int dy, int sx, int sy, int w,
 // Same as tigrBlit, but tints the source bitmap with a color.
 void tigrBlitTint(Tigr *dest, Tigr *src, int dx, int dy, int sx, int sy, int w, int h, TPixel tint);
 
+// Same as tigrBlitAlpha, but dx/dy may be fractional.
+// The source is resampled with a 2-tap linear filter along the x-axis,
+// so the blit covers w+1 destination columns. dy is floored.
+void tigrBlitSubpixel(Tigr *dest, Tigr *src, float dx, float dy, int sx, int sy, int w, int h, float alpha);
+
+// Upscales src by a whole factor into dst, which must be exactly factor times its size.
+// tigrScaleNearest turns each pixel into a factor x factor block.
+// tigrScaleSmooth rounds off the diagonal edges of pixel art without blurring it
+// (Scale2x/Scale3x, or Scale2x twice for 4); other factors fall back to nearest.
+// Returns non-zero on success, zero if dst is the wrong size.
+int tigrScaleNearest(Tigr *dst, Tigr *src, int factor);
+int tigrScaleSmooth(Tigr *dst, Tigr *src, int factor);
+
 // Helper for making colors.
 TIGR_INLINE TPixel tigrRGB(unsigned char r, unsigned char g, unsigned char b)
 {
@@ -191,15 +237,37 @@ typedef struct {
 int tigrTouch(Tigr *bmp, TigrTouchPoint* points, int maxPoints);
 
 // Reads the keyboard for a window.
-// Returns non-zero if a key is pressed/held.
-// tigrKeyDown tests for the initial press, tigrKeyHeld repeats each frame.
+// Returns non-zero if a key is pressed/held/released.
+// tigrKeyDown tests for the initial press, tigrKeyHeld repeats each frame,
+// tigrKeyUp tests for the release.
 int tigrKeyDown(Tigr *bmp, int key);
 int tigrKeyHeld(Tigr *bmp, int key);
+int tigrKeyUp(Tigr *bmp, int key);
 
 // Reads character input for a window.
 // Returns the Unicode value of the last key pressed, or 0 if none.
 int tigrReadChar(Tigr *bmp);
 
+// Input events, in the order they happened.
+typedef enum {
+    TIGR_EVENT_NONE, TIGR_EVENT_MOUSE_DOWN, TIGR_EVENT_MOUSE_UP, TIGR_EVENT_MOUSE_MOVE,
+    TIGR_EVENT_KEY_DOWN, TIGR_EVENT_KEY_UP
+} TigrEventType;
+
+typedef struct {
+    int type;      // TigrEventType
+    int x, y;      // Mouse position in bitmap pixels
+    int buttons;   // Mouse buttons held after the event (1 = left, 2 = right, 4 = middle)
+    int button;    // Button that was pressed or released, for mouse down/up events
+    int key;       // TKey, for key events
+    double time;   // Seconds on tigrClock()
+} TigrEvent;
+
+// Takes the oldest queued input event of a window. Events are queued by tigrUpdate.
+// Returns non-zero if an event was read, zero if the queue is empty.
+// Holds the last 64 events; older ones are dropped if the queue is not read.
+int tigrPollEvent(Tigr *bmp, TigrEvent *event);
+
 
 // Bitmap I/O -------------------------------------------------------------
 
@@ -212,6 +280,14 @@ Tigr *tigrLoadImageMem(const void *data, int length);
 // On error, returns zero and sets errno.
 int tigrSaveImage(const char *fileName, Tigr *bmp);
 
+// Same as tigrSaveImage with a choice of speed: level 0 stores the pixels
+// uncompressed (fastest, largest), 1 filters and compresses them (the default).
+int tigrSaveImageLevel(const char *fileName, Tigr *bmp, int level);
+
+// Encodes a PNG into memory, at a level as above. Free it yourself after with 'free'.
+// On error, returns NULL and sets errno.
+void *tigrEncodeImage(Tigr *bmp, int level, int *length);
+
 
 // Helpers ----------------------------------------------------------------
 
@@ -219,6 +295,10 @@ int tigrSaveImage(const char *fileName, Tigr *bmp);
 // or zero on the first call.
 float tigrTime();
 
+// Returns a monotonic clock in seconds, the one input events are stamped with.
+// Only differences between two readings are meaningful.
+double tigrClock();
+
 // Displays an error message and quits. (UTF-8)
 // 'bmp' can be NULL.
 void tigrError(Tigr *bmp, const char *message, ...);